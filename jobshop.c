@@ -20,7 +20,9 @@ int   num_stations, num_job_types, i, j, num_machines[MAX_NUM_STATIONS + 1],
       route[MAX_NUM_JOB_TYPES +1][MAX_NUM_STATIONS + 1],
       num_machines_busy[MAX_NUM_STATIONS + 1], job_type, task;
 float mean_interarrival, length_simulation, prob_distrib_job_type[26],
+      prob_job_type[MAX_NUM_JOB_TYPES + 1],
       mean_service[MAX_NUM_JOB_TYPES +1][ MAX_NUM_STATIONS + 1];
+struct discrete *job_type_distrib;
 FILE  *infile, *outfile;
 
 /* Declare non-simlib functions. */
@@ -54,6 +56,14 @@ main()  /* Main function. */
     for (i = 1; i <= num_job_types; ++i)
         fscanf(infile, "%f", &prob_distrib_job_type[i]);
 
+    /* Prepare the job-type distribution for alias sampling from the point
+       probabilities (the input gives the distribution function). */
+
+    for (i = 1; i <= num_job_types; ++i)
+        prob_job_type[i] = prob_distrib_job_type[i]
+                           - prob_distrib_job_type[i - 1];
+    job_type_distrib = discrete_build(prob_job_type, num_job_types);
+
     /* Write report heading and input parameters. */
 
     fprintf(outfile, "Job-shop model\n\n");
@@ -138,6 +148,7 @@ main()  /* Main function. */
 
     } while (next_event_type != EVENT_END_SIMULATION);
 
+    discrete_free(job_type_distrib);
     fclose(infile);
     fclose(outfile);
 
@@ -161,7 +172,7 @@ void arrive(int new_job)  /* Function to serve as both an arrival event of a job
 
         event_schedule(sim_time + expon(mean_interarrival, STREAM_INTERARRIVAL),
                        EVENT_ARRIVAL);
-        job_type = random_integer(prob_distrib_job_type, STREAM_JOB_TYPE);
+        job_type = discrete_sample(job_type_distrib, STREAM_JOB_TYPE);
         task     = 1;
     }
 
@@ -52,6 +52,10 @@ main()  /* Main function. */
 
     maxatr = 4;  /* NEVER SET maxatr TO BE SMALLER THAN 4. */
 
+    /* Have simlib tally the delay of each customer leaving the queue. */
+
+    list_set_sampst(LIST_QUEUE, SAMPST_DELAYS);
+
     /* Initialize the model. */
 
     init_model();
@@ -108,10 +112,9 @@ void arrive(void)  /* Arrival event function. */
 
     if (list_size[LIST_SERVER] == 1) {
 
-        /* Server is busy, so store time of arrival of arriving customer at end
-           of list LIST_QUEUE. */
+        /* Server is busy, so place the arriving customer at the end of list
+           LIST_QUEUE (simlib records the time of arrival). */
 
-        transfer[1] = sim_time;
         list_file(LAST, LIST_QUEUE);
     }
 
@@ -153,12 +156,11 @@ void depart(void)  /* Departure event function. */
 
     else {
 
-        /* The queue is nonempty, so remove the first customer from the queue,
-           register delay, increment the number of customers delayed, and
-           schedule departure. */
+        /* The queue is nonempty, so remove the first customer from the queue
+           (which registers the delay), increment the number of customers
+           delayed, and schedule departure. */
 
         list_remove(FIRST, LIST_QUEUE);
-        sampst(sim_time - transfer[1], SAMPST_DELAYS);
         ++num_custs_delayed;
         event_schedule(sim_time + expon(mean_service, STREAM_SERVICE),
                        EVENT_DEPARTURE);
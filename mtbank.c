@@ -25,6 +25,8 @@ void report(void);
 
 main()  /* Main function. */
 {
+    int teller;
+
     /* Open input and output files. */
 
     infile  = fopen("mtbank.in",  "r");
@@ -58,6 +60,18 @@ main()  /* Main function. */
 
         maxatr = 4;  /* NEVER SET maxatr TO BE SMALLER THAN 4. */
 
+        /* Restart the random-number streams so that every configuration sees
+           the same random inputs (common random numbers). */
+
+        lcgrand_crn(0);
+
+        /* Skip length statistics on the event list and the teller lists,
+           which are never reported. */
+
+        list_set_stats(LIST_EVENT, STATS_NONE);
+        for (teller = 1; teller <= num_tellers; ++teller)
+            list_set_stats(num_tellers + teller, STATS_NONE);
+
         /* Schedule the first arrival. */
 
         event_schedule(expon(mean_interarrival, STREAM_INTERARRIVAL),
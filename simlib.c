@@ -5,14 +5,30 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
+#include <ctype.h>
 #include "simlibdefs.h"
 
-/* Declare simlib global variables. */
-
-int    *list_rank, *list_size, next_event_type, maxatr = 0, maxlist = 0;
-float  *transfer, sim_time, prob_distrib[26];
-struct master {
+#if defined(__unix__) || defined(__APPLE__)
+#define SIMLIB_MMAP                     /* Data files are mapped. */
+#define SIMLIB_PTHREADS                 /* Replications run in parallel. */
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/* Declare simlib global variables.  They, and the file-scope variables below
+   that are not constant tables, are the state of the simulation in the
+   context the thread is using (see simlib_ctx_use). */
+
+SIMLIB_THREAD int    *list_rank, *list_size, next_event_type, maxatr = 0,
+                     maxlist = 0;
+SIMLIB_THREAD float  *transfer, sim_time, prob_distrib[26];
+SIMLIB_THREAD struct master {
     float  *value;
+    float  time;                /* Time filed, for residence times. */
     struct master *pr;
     struct master *sr;
 } **head, **tail;
@@ -28,17 +44,119 @@ int   event_cancel(int event_type);
 float sampst(float value, int variable);
 float timest(float value, int variable);
 float filest(int list);
+void  sampst_reset(int variable);
+void  timest_reset(int variable);
+void  filest_reset(int list);
+void  list_set_stats(int list, int level);
+void  list_set_sampst(int list, int variable);
+float filest_residence(int list);
+void  stat_init(struct statistic *stat);
+void  stat_tally(struct statistic *stat, double value, double weight);
+void  stat_merge(struct statistic *into, struct statistic *from);
+double stat_variance(struct statistic *stat);
+double stat_quantile(struct statistic *stat, double p);
+double stat_half_width(struct statistic *stat, double level);
+void  timest_sample_every(int variable, float dt, int capacity);
+int   timest_series(int variable, float levels[], int n);
+int   timest_series_write(FILE *unit, int variable);
+void  simlib_stats_snapshot(struct simlib_stats *snap);
+void  simlib_stats_merge(struct simlib_stats *into, struct simlib_stats *from);
 void  out_sampst(FILE *unit, int lowvar, int highvar);
 void  out_timest(FILE *unit, int lowvar, int highvar);
 void  out_filest(FILE *unit, int lowlist, int highlist);
 void  pprint_out(FILE *unit, int i);
 float expon(float mean, int stream);
 int   random_integer(float prob_distrib[], int stream);
+struct discrete *discrete_build(float probs[], int n);
+int   discrete_sample(struct discrete *dist, int stream);
+void  discrete_free(struct discrete *dist);
 float uniform(float a, float b, int stream);
 float erlang(int m, float mean, int stream);
+double expon_d(double mean, int stream);
+double uniform_d(double a, double b, int stream);
+double erlang_d(int m, double mean, int stream);
+float normal(float mu, float sigma, int stream);
+double normal_d(double mu, double sigma, int stream);
+void  variate_method(int method);
+float gamma_variate(float alpha, float mean, int stream);
+double gamma_variate_d(double alpha, double mean, int stream);
+void  dist_init(struct distribution *dist, int type, double a, double b,
+                double c);
+double dist_sample(struct distribution *dist, int stream);
+void  dist_batch(struct distribution *dist, double out[], int n, int stream);
+void  expon_batch(float out[], int n, float mean, int stream);
+void  uniform_batch(float out[], int n, float a, float b, int stream);
+void  erlang_batch(float out[], int n, int m, float mean, int stream);
+void  empirical_write(char *path, double values[], long n);
+struct empirical *empirical_load(char *path);
+double empirical_sample(struct empirical *emp, int stream);
+void  empirical_free(struct empirical *emp);
+long  trace_convert(char *csv_path, char *trace_path);
+struct trace *trace_open(char *path);
+int   trace_schedule(struct trace *tr, int type_of_event);
+void  trace_close(struct trace *tr);
+struct nhpp *nhpp_build(float start[], float rate[], int n, float period);
+float nhpp_next(struct nhpp *arrivals, int stream);
+void  nhpp_reset(struct nhpp *arrivals);
+void  nhpp_free(struct nhpp *arrivals);
 float lcgrand(int stream);
+double lcgrand_d(int stream);
 void  lcgrandst(long zset, int stream);
 long  lcgrandgt(int stream);
+void  lcgrand_jump(int stream, long k);
+void  lcgrand_substream(int stream, int rep);
+void  lcgrand_backend(int backend);
+void  lcgrand_fill(int stream, float u[], int n);
+void  lcgrand_buffer(int stream, int size);
+void  lcgrand_entity(int stream, long entity);
+void  lcgrand_crn(int rep);
+void  lcgrand_sobol(int stream, int dims);
+void  lcgrand_set_antithetic(int stream, int on);
+void  simlib_antithetic(void (*model)(double est[]), int n, double est[]);
+double philox_uniform(int rep, int stream, long entity, long draw);
+struct simlib_ctx *simlib_ctx_create(void);
+struct simlib_ctx *simlib_ctx_use(struct simlib_ctx *ctx);
+void  simlib_ctx_free(struct simlib_ctx *ctx);
+void  simlib_replicate(void (*model)(int rep), int n_reps, int n_threads,
+                       struct simlib_stats *across);
+
+
+/* Accumulators for sampst, timest and list residence times, and the
+   statistics level of each list.  The accumulators are kept at file scope
+   (rather than inside the functions) so that they can be snapshot and
+   merged, and are allocated by init_simlib for each context, with
+   SVAR_SIZE, TVAR_SIZE and LIST_SIZE entries. */
+
+static SIMLIB_THREAD struct statistic *sampst_stat, *timest_stat, *residence;
+static SIMLIB_THREAD float            *preval, *tlvc;
+static SIMLIB_THREAD int              *list_stats, *list_sampst;
+
+/* Fixed-interval time series of a timest variable, set up by
+   timest_sample_every.  Interval k (k = 0, 1, ...) covers
+   [start + k * dt, start + (k + 1) * dt); the averages of the last "capacity"
+   completed intervals are kept in a ring buffer, interval k in slot
+   k % capacity.  series has TVAR_SIZE entries. */
+
+static SIMLIB_THREAD struct series {
+    double start, dt;           /* Start of interval 0 and interval length. */
+    double area;                /* Area so far in the current interval. */
+    long   intervals;           /* Number of completed intervals. */
+    int    capacity;            /* Number of slots in levels. */
+    float  *levels;             /* Ring buffer of interval averages. */
+} **series;
+
+/* Method used by expon, expon_d, normal and normal_d (variate_method), and
+   the ziggurat generators, which are defined with the random-number
+   generator below. */
+
+static SIMLIB_THREAD int variates = VARIATE_INVERSION;
+static int    ziggurat_stream(int stream);
+static double ziggurat_expon(int stream);
+static double ziggurat_normal(int stream);
+static double normal_quantile(double p);
+static double rng_uniform(int stream);
+static void   stat_accumulate(struct statistic *stat, double value,
+                              double weight);
 
 
 void init_simlib()
@@ -65,6 +183,29 @@ void init_simlib()
     tail      = (struct master **) calloc(listsize,   sizeof(struct master *));
     transfer  = (float *)          calloc(maxatr + 1, sizeof(float));
 
+    /* Allocate the statistics of this context when it is first initialized. */
+
+    if (sampst_stat == NULL) {
+        sampst_stat = (struct statistic *) calloc(SVAR_SIZE,
+                                                  sizeof(struct statistic));
+        timest_stat = (struct statistic *) calloc(TVAR_SIZE,
+                                                  sizeof(struct statistic));
+        residence   = (struct statistic *) calloc(LIST_SIZE,
+                                                  sizeof(struct statistic));
+        preval      = (float *)            calloc(TVAR_SIZE, sizeof(float));
+        tlvc        = (float *)            calloc(TVAR_SIZE, sizeof(float));
+        list_stats  = (int *)              calloc(LIST_SIZE, sizeof(int));
+        list_sampst = (int *)              calloc(LIST_SIZE, sizeof(int));
+        series      = (struct series **)   calloc(TVAR_SIZE,
+                                                  sizeof(struct series *));
+        if (sampst_stat == NULL || timest_stat == NULL || residence == NULL
+            || preval == NULL || tlvc == NULL || list_stats == NULL
+            || list_sampst == NULL || series == NULL) {
+            printf("\nOut of memory for the simlib statistics\n");
+            exit(1);
+        }
+    }
+
     /* Initialize list attributes. */
 
     for(list = 1; list <= maxlist; ++list) {
@@ -78,6 +219,14 @@ void init_simlib()
 
     list_rank[LIST_EVENT] = EVENT_TIME;
 
+    /* Keep time-average length statistics on every list by default. */
+
+    for(list = 0; list <= MAX_LIST; ++list) {
+        list_stats[list]  = STATS_TIME_AVG;
+        list_sampst[list] = 0;
+        stat_init(&residence[list]);
+    }
+
     /* Initialize statistical routines. */
 
     sampst(0.0, 0);
@@ -219,11 +368,30 @@ void list_file(int option, int list)
     (*row).value = (float *) calloc(maxatr + 1, sizeof(float));
     for (item = 0; item <= maxatr; ++item)
         (*row).value[item] = transfer[item];
+    (*row).time = sim_time;   /* For residence-time statistics. */
 
 
     /* Update the area under the number-in-list curve. */
 
-    timest((float)list_size[list], TIM_VAR + list);
+    if (list_stats[list] != STATS_NONE)
+        timest((float)list_size[list], TIM_VAR + list);
+}
+
+
+static void list_tally_residence(int list, float time_filed)
+{
+
+/* Tally the residence time of a record filed at time "time_filed" that is
+   leaving list "list", both in the list's own residence statistics
+   (STATS_FULL) and in its associated sampst variable, if any. */
+
+    float delay;
+
+    delay = sim_time - time_filed;
+    if(list_stats[list] == STATS_FULL)
+        stat_tally(&residence[list], delay, 1.0);
+    if(list_sampst[list] > 0)
+        sampst(delay, list_sampst[list]);
 }
 
 
@@ -305,11 +473,14 @@ void list_remove(int option, int list)
 
     free((char *)transfer);
     transfer = (*row).value;
+    if (list_stats[list] == STATS_FULL || list_sampst[list] > 0)
+        list_tally_residence(list, (*row).time);
     free((char *)row);
 
     /* Update the area under the number-in-list curve. */
 
-    timest((float)list_size[list], TIM_VAR + list);
+    if (list_stats[list] != STATS_NONE)
+        timest((float)list_size[list], TIM_VAR + list);
 }
 
 
@@ -361,8 +532,8 @@ int event_cancel(int event_type)
    attributes in transfer.  If something is cancelled, event_cancel returns 1;
    if no match is found, event_cancel returns 0. */
 
-    struct       master *row, *ahead, *behind;
-    static float high, low, value;
+    struct master *row, *ahead, *behind;
+    float  high, low, value;
 
     /* If the event list is empty, do nothing and return 0. */
 
@@ -420,11 +591,14 @@ int event_cancel(int event_type)
 
     free((char *)transfer);       /* Free the old transfer. */
     transfer = (*row).value;      /* Transfer the data. */
+    if (list_stats[LIST_EVENT] == STATS_FULL || list_sampst[LIST_EVENT] > 0)
+        list_tally_residence(LIST_EVENT, (*row).time);
     free((char *)row);            /* Free the space vacated by row. */
 
     /* Update the area under the number-in-event-list curve. */
 
-    timest((float)list_size[LIST_EVENT], TIM_VAR + LIST_EVENT);
+    if (list_stats[LIST_EVENT] != STATS_NONE)
+        timest((float)list_size[LIST_EVENT], TIM_VAR + LIST_EVENT);
     return 1;
 }
 
@@ -443,8 +617,7 @@ float sampst(float value, int variable)
            [3] = maximum of observations
            [4] = minimum of observations */
 
-    static int   ivar, num_observations[SVAR_SIZE];
-    static float max[SVAR_SIZE], min[SVAR_SIZE], sum[SVAR_SIZE];
+    int ivar;
 
     /* If the variable value is improper, stop the simulation. */
 
@@ -457,33 +630,59 @@ float sampst(float value, int variable)
     /* Execute the desired option. */
 
     if(variable > 0) { /* Update. */
-        sum[variable] += value;
-        if(value > max[variable]) max[variable] = value;
-        if(value < min[variable]) min[variable] = value;
-        num_observations[variable]++;
+        stat_tally(&sampst_stat[variable], value, 1.0);
         return 0.0;
     }
 
     if(variable < 0) { /* Report summary statistics in transfer. */
         ivar        = -variable;
-        transfer[2] = (float) num_observations[ivar];
-        transfer[3] = max[ivar];
-        transfer[4] = min[ivar];
-        if(num_observations[ivar] == 0)
-            transfer[1] = 0.0;
-        else
-            transfer[1] = sum[ivar] / transfer[2];
+        transfer[1] = sampst_stat[ivar].mean;
+        transfer[2] = sampst_stat[ivar].weight;
+        transfer[3] = sampst_stat[ivar].max;
+        transfer[4] = sampst_stat[ivar].min;
         return transfer[1];
     }
 
     /* Initialize the accumulators. */
 
-    for(ivar=1; ivar <= MAX_SVAR; ++ivar) {
-        sum[ivar]              = 0.0;
-        max[ivar]              = -INFINITY;
-        min[ivar]              =  INFINITY;
-        num_observations[ivar] = 0;
+    for(ivar=1; ivar <= MAX_SVAR; ++ivar)
+        stat_init(&sampst_stat[ivar]);
+}
+
+
+static void series_advance(struct series *ser, float level, float from)
+{
+
+/* Extend time series "ser" of a variable that has been at level "level" since
+   time "from" up to the current time, recording every interval completed on
+   the way. */
+
+    double boundary, t;
+
+    t        = from;
+    boundary = ser->start + (ser->intervals + 1) * ser->dt;
+    while (boundary <= sim_time) {
+        ser->area += level * (boundary - t);
+        ser->levels[ser->intervals % ser->capacity] = ser->area / ser->dt;
+        ser->area  = 0.0;
+        t          = boundary;
+        boundary   = ser->start + (++ser->intervals + 1) * ser->dt;
     }
+    ser->area += level * (sim_time - t);
+}
+
+
+static void timest_update(int variable)
+{
+
+/* Add the area of timest variable "variable" up to the current time to its
+   accumulators and time series, without reporting anything in transfer. */
+
+    if(series[variable] != NULL)
+        series_advance(series[variable], preval[variable], tlvc[variable]);
+    stat_accumulate(&timest_stat[variable], preval[variable],
+                    sim_time - tlvc[variable]);
+    tlvc[variable] = sim_time;
 }
 
 
@@ -502,9 +701,7 @@ float timest(float value, int variable)
    Note that variables TIM_VAR + 1 through TVAR_SIZE are used for automatic
    record keeping on the length of lists 1 through MAX_LIST. */
 
-    int          ivar;
-    static float area[TVAR_SIZE], max[TVAR_SIZE], min[TVAR_SIZE],
-                 preval[TVAR_SIZE], tlvc[TVAR_SIZE], treset;
+    int ivar;
 
     /* If the variable value is improper, stop the simulation. */
 
@@ -517,34 +714,34 @@ float timest(float value, int variable)
     /* Execute the desired option. */
 
     if(variable > 0) { /* Update. */
-        area[variable] += (sim_time - tlvc[variable]) * preval[variable];
-        if(value > max[variable]) max[variable] = value;
-        if(value < min[variable]) min[variable] = value;
+        timest_update(variable);
+        if(value > timest_stat[variable].max) timest_stat[variable].max = value;
+        if(value < timest_stat[variable].min) timest_stat[variable].min = value;
         preval[variable] = value;
-        tlvc[variable]   = sim_time;
         return 0.0;
     }
 
     if(variable < 0) { /* Report summary statistics in transfer. */
         ivar         = -variable;
-        area[ivar]   += (sim_time - tlvc[ivar]) * preval[ivar];
-        tlvc[ivar]   = sim_time;
-        transfer[1]  = area[ivar] / (sim_time - treset);
-        transfer[2]  = max[ivar];
-        transfer[3]  = min[ivar];
+        timest_update(ivar);
+        transfer[1]  = timest_stat[ivar].mean;
+        transfer[2]  = timest_stat[ivar].max;
+        transfer[3]  = timest_stat[ivar].min;
         return transfer[1];
     }
 
     /* Initialize the accumulators. */
 
     for(ivar = 1; ivar <= MAX_TVAR; ++ivar) {
-        area[ivar]   = 0.0;
-        max[ivar]    = -INFINITY;
-        min[ivar]    =  INFINITY;
+        stat_init(&timest_stat[ivar]);
         preval[ivar] = 0.0;
         tlvc[ivar]   = sim_time;
+        if(series[ivar] != NULL) { /* Restart the time series. */
+            series[ivar]->start     = sim_time;
+            series[ivar]->area      = 0.0;
+            series[ivar]->intervals = 0;
+        }
     }
-    treset = sim_time;
 }
 
 
@@ -561,6 +758,511 @@ float filest(int list)
 }
 
 
+void sampst_reset(int variable)
+{
+
+/* Reset the accumulators of sampst variable "variable" only, leaving all other
+   variables alone (e.g. to delete a warm-up period). */
+
+    if(!((variable >= 1) && (variable <= MAX_SVAR))) {
+        printf("\n%d is an improper value for a sampst variable at time %f\n",
+            variable, sim_time);
+        exit(1);
+    }
+
+    stat_init(&sampst_stat[variable]);
+}
+
+
+void timest_reset(int variable)
+{
+
+/* Reset the accumulators of timest variable "variable" only.  The current
+   level of the variable is kept, so the time average restarts from the
+   current time at that level, which also becomes the new max and min. */
+
+    if(!((variable >= 1) && (variable <= MAX_TVAR))) {
+        printf("\n%d is an improper value for a timest variable at time %f\n",
+            variable, sim_time);
+        exit(1);
+    }
+
+    /* Bring the time series up to now, since its intervals are not reset. */
+
+    if(series[variable] != NULL)
+        series_advance(series[variable], preval[variable], tlvc[variable]);
+
+    stat_init(&timest_stat[variable]);
+    timest_stat[variable].max = preval[variable];
+    timest_stat[variable].min = preval[variable];
+    tlvc[variable]            = sim_time;
+}
+
+
+void filest_reset(int list)
+{
+
+/* Reset the length statistics of list "list" without touching its contents.
+   This uses timest variable TIM_VAR + list. */
+
+    if(!((list >= 0) && (list <= MAX_LIST))) {
+        printf("\nInvalid list %d for filest_reset at time %f\n",
+               list, sim_time);
+        exit(1);
+    }
+
+    timest_reset(TIM_VAR + list);
+    stat_init(&residence[list]);
+}
+
+
+void list_set_stats(int list, int level)
+{
+
+/* Set the statistics kept on list "list":
+   level = STATS_NONE      no statistics (list_file and list_remove skip timest)
+           STATS_TIME_AVG  time-average length via timest variable
+                           TIM_VAR + list (the default set by init_simlib)
+           STATS_FULL      length statistics plus the residence time of every
+                           record removed, reported by filest_residence
+   Length statistics restart from the current time at the current length when
+   a list leaves STATS_NONE. */
+
+    if(!((list >= 0) && (list <= MAX_LIST))) {
+        printf("\nInvalid list %d for list_set_stats at time %f\n",
+               list, sim_time);
+        exit(1);
+    }
+
+    if(!((level >= STATS_NONE) && (level <= STATS_FULL))) {
+        printf(
+            "\n%d is an invalid statistics level for list %d at time %f\n",
+            level, list, sim_time);
+        exit(1);
+    }
+
+    if(list_stats[list] == STATS_NONE && level != STATS_NONE) {
+        preval[TIM_VAR + list] = (float) list_size[list];
+        timest_reset(TIM_VAR + list);
+    }
+    list_stats[list] = level;
+}
+
+
+void list_set_sampst(int list, int variable)
+{
+
+/* Feed the residence time of every record removed from list "list" into
+   sampst variable "variable" (0 stops doing so).  The list engine stamps each
+   record with its filing time, so the model need neither store the arrival
+   time in an attribute nor tally the delay itself.  Records that never enter
+   the list (e.g. customers served at once) must still be tallied by the
+   model. */
+
+    if(!((list >= 0) && (list <= MAX_LIST))) {
+        printf("\nInvalid list %d for list_set_sampst at time %f\n",
+               list, sim_time);
+        exit(1);
+    }
+
+    if(!((variable >= 0) && (variable <= MAX_SVAR))) {
+        printf("\n%d is an improper value for a sampst variable at time %f\n",
+            variable, sim_time);
+        exit(1);
+    }
+
+    list_sampst[list] = variable;
+}
+
+
+float filest_residence(int list)
+{
+
+/* Report statistics on the residence times of records removed from list
+   "list" (which must be at level STATS_FULL) in transfer:
+       [1] = average residence time
+       [2] = number of records removed
+       [3] = maximum residence time
+       [4] = minimum residence time */
+
+    if(!((list >= 0) && (list <= MAX_LIST))) {
+        printf("\nInvalid list %d for filest_residence at time %f\n",
+               list, sim_time);
+        exit(1);
+    }
+
+    transfer[1] = residence[list].mean;
+    transfer[2] = residence[list].weight;
+    transfer[3] = residence[list].max;
+    transfer[4] = residence[list].min;
+    return transfer[1];
+}
+
+
+void stat_init(struct statistic *stat)
+{
+
+/* Clear statistic "stat": no weight, max -1E30 and min 1E30, empty
+   histogram. */
+
+    int bin;
+
+    stat->weight = 0.0;
+    stat->mean   = 0.0;
+    stat->m2     = 0.0;
+    stat->max    = -INFINITY;
+    stat->min    =  INFINITY;
+    for(bin = 0; bin < STAT_BINS; ++bin)
+        stat->hist[bin] = 0.0;
+}
+
+
+static int stat_bin(double value) /* Histogram bin holding "value". */
+{
+    int    exponent, bin;
+    double fraction;
+
+    if(value < ldexp(1.0, STAT_MIN_EXP)) return 0;
+
+    /* value = 2 * fraction * 2^(exponent - 1), with 1 <= 2 * fraction < 2. */
+
+    fraction = frexp(value, &exponent);
+    bin = 1 + (exponent - 1 - STAT_MIN_EXP) * STAT_SUBBINS
+            + (int)((2.0 * fraction - 1.0) * STAT_SUBBINS);
+    return (bin < STAT_BINS) ? bin : STAT_BINS - 1;
+}
+
+
+static void stat_accumulate(struct statistic *stat, double value,
+                            double weight)
+{
+
+/* Add "value" with weight "weight" to the mean, sum of squared deviations and
+   histogram of "stat", using West's weighted form of Welford's update, but
+   not to its extremes:  timest tracks those on the levels it is given rather
+   than on the intervals it tallies. */
+
+    double delta;
+
+    if(weight <= 0.0) return;
+
+    stat->weight += weight;
+    delta         = value - stat->mean;
+    stat->mean   += delta * weight / stat->weight;
+    stat->m2     += weight * delta * (value - stat->mean);
+    stat->hist[stat_bin(value)] += weight;
+}
+
+
+void stat_tally(struct statistic *stat, double value, double weight)
+{
+
+/* Add "value" with weight "weight" to statistic "stat", including its
+   extremes. */
+
+    if(weight <= 0.0) return;
+
+    stat_accumulate(stat, value, weight);
+    if(value > stat->max) stat->max = value;
+    if(value < stat->min) stat->min = value;
+}
+
+
+void stat_merge(struct statistic *into, struct statistic *from)
+{
+
+/* Combine statistic "from" into statistic "into", as if every value tallied
+   into "from" had also been tallied into "into" (Chan, Golub and LeVeque's
+   pairwise update). */
+
+    int    bin;
+    double weight, delta;
+
+    if(from->max > into->max) into->max = from->max;
+    if(from->min < into->min) into->min = from->min;
+
+    if(from->weight <= 0.0) return;
+
+    weight      = into->weight + from->weight;
+    delta       = from->mean - into->mean;
+    into->mean += delta * from->weight / weight;
+    into->m2   += from->m2 + delta * delta * into->weight * from->weight / weight;
+    into->weight = weight;
+    for(bin = 0; bin < STAT_BINS; ++bin)
+        into->hist[bin] += from->hist[bin];
+}
+
+
+double stat_variance(struct statistic *stat)
+{
+
+/* Return the sample variance of the values tallied into "stat" (m2 divided by
+   weight - 1).  For a time-persistent statistic the time-weighted variance is
+   m2 / weight instead. */
+
+    if(stat->weight <= 1.0) return 0.0;
+    return stat->m2 / (stat->weight - 1.0);
+}
+
+
+double stat_quantile(struct statistic *stat, double p)
+{
+
+/* Estimate the p-quantile (0 <= p <= 1) of the values tallied into "stat" from
+   its histogram, interpolating linearly within the bin and clamping to the
+   observed extremes.  The relative error is at most 1 / STAT_SUBBINS. */
+
+    int    bin;
+    double target, cumulative, lower, width, value;
+
+    if(stat->weight <= 0.0) return 0.0;
+
+    target     = p * stat->weight;
+    cumulative = stat->hist[0];
+    if(cumulative >= target) return stat->min;
+
+    for(bin = 1; bin < STAT_BINS - 1; ++bin) {
+        if(cumulative + stat->hist[bin] >= target) break;
+        cumulative += stat->hist[bin];
+    }
+
+    width = ldexp(1.0, STAT_MIN_EXP + (bin - 1) / STAT_SUBBINS) / STAT_SUBBINS;
+    lower = ldexp(1.0, STAT_MIN_EXP + (bin - 1) / STAT_SUBBINS)
+            + ((bin - 1) % STAT_SUBBINS) * width;
+    value = lower;
+    if(stat->hist[bin] > 0.0)
+        value += width * (target - cumulative) / stat->hist[bin];
+
+    if(value > stat->max) value = stat->max;
+    if(value < stat->min) value = stat->min;
+    return value;
+}
+
+
+#define HALF_PI  1.57079632679489661923      /* pi / 2. */
+
+static double t_quantile(double p, double df)
+{
+
+/* Return the upper p/2-quantile of Student's t distribution with df degrees
+   of freedom (so that |T| exceeds it with probability p), by Hill's
+   algorithm ("Algorithm 396: Student's t-Quantiles", Comm. ACM 13, 1970),
+   exact for df = 1 and 2 and otherwise accurate to about 1E-6. */
+
+    double a, b, c, d, x, y;
+
+    if(df < 1.5) return cos(p * HALF_PI) / sin(p * HALF_PI);
+    if(df < 2.5) return sqrt(2.0 / (p * (2.0 - p)) - 2.0);
+
+    a = 1.0 / (df - 0.5);
+    b = 48.0 / (a * a);
+    c = ((20700.0 * a / b - 98.0) * a - 16.0) * a + 96.36;
+    d = ((94.5 / (b + c) - 3.0) / b + 1.0) * sqrt(a * HALF_PI) * df;
+    y = pow(d * p, 2.0 / df);
+
+    if(y > 0.05 + a) { /* Expansion about the normal quantile. */
+        x = normal_quantile(0.5 * p);
+        y = x * x;
+        if(df < 5.0) c += 0.3 * (df - 4.5) * (x + 0.6);
+        c = (((0.05 * d * x - 5.0) * x - 7.0) * x - 2.0) * x + b + c;
+        y = (((((0.4 * y + 6.3) * y + 36.0) * y + 94.5) / c - y - 3.0) / b
+             + 1.0) * x;
+        y = expm1(a * y * y);
+    }
+    else
+        y = ((1.0 / (((df + 6.0) / (df * y) - 0.089 * d - 0.822)
+                     * (df + 2.0) * 3.0) + 0.5 / (df + 4.0)) * y - 1.0)
+            * (df + 1.0) / (df + 2.0) + 1.0 / y;
+    return sqrt(df * y);
+}
+
+
+double stat_half_width(struct statistic *stat, double level)
+{
+
+/* Return the half-width of a "level" (0 < level < 1) confidence interval for
+   the mean of the values tallied into "stat" with weight 1 each, taken as
+   independent observations (such as the replication averages left by
+   simlib_replicate):  t(n - 1, (1 + level) / 2) * sqrt(variance / n).  With
+   fewer than two values there is no interval and 0 is returned. */
+
+    if(!(level > 0.0 && level < 1.0)) {
+        printf("\n%f is an improper confidence level\n", level);
+        exit(1);
+    }
+    if(stat->weight < 2.0) return 0.0;
+    return t_quantile(1.0 - level, stat->weight - 1.0)
+           * sqrt(stat_variance(stat) / stat->weight);
+}
+
+
+void timest_sample_every(int variable, float dt, int capacity)
+{
+
+/* Record the time average of timest variable "variable" over successive
+   intervals of length dt, starting now, keeping the most recent "capacity"
+   intervals in a ring buffer allocated here once.  Sampling needs no events:
+   intervals are closed whenever the variable is updated or reported.  A dt or
+   capacity of zero stops sampling.  (For a list at level STATS_NONE there are
+   no updates to sample.) */
+
+    struct series *ser;
+
+    if(!((variable >= 1) && (variable <= MAX_TVAR))) {
+        printf("\n%d is an improper value for a timest variable at time %f\n",
+            variable, sim_time);
+        exit(1);
+    }
+
+    /* Release any previous time series. */
+
+    if(series[variable] != NULL) {
+        free((char *)series[variable]->levels);
+        free((char *)series[variable]);
+        series[variable] = NULL;
+    }
+
+    if(dt <= 0.0 || capacity <= 0) return;
+
+    ser = (struct series *) malloc(sizeof(struct series));
+    if(ser != NULL)
+        ser->levels = (float *) calloc(capacity, sizeof(float));
+    if(ser == NULL || ser->levels == NULL) {
+        printf("\nOut of memory for the time series of timest variable %d\n",
+               variable);
+        exit(1);
+    }
+
+    /* Close the current level's interval so that the series starts now. */
+
+    timest_update(variable);
+
+    ser->start      = sim_time;
+    ser->dt         = dt;
+    ser->area       = 0.0;
+    ser->intervals  = 0;
+    ser->capacity   = capacity;
+    series[variable] = ser;
+}
+
+
+int timest_series(int variable, float levels[], int n)
+{
+
+/* Copy up to n of the most recent interval averages of timest variable
+   "variable", oldest first, into levels[0], levels[1], ... and return how many
+   were copied.  Intervals completed up to the current time are included.  The
+   start time of the first copied interval is returned in transfer[1] and the
+   interval length in transfer[2]. */
+
+    struct series *ser;
+    long   first, k;
+
+    if(!((variable >= 1) && (variable <= MAX_TVAR))) return 0;
+    ser = series[variable];
+    if(ser == NULL) return 0;
+
+    timest_update(variable);
+
+    first = ser->intervals - n;
+    if(first < ser->intervals - ser->capacity)
+        first = ser->intervals - ser->capacity;
+    if(first < 0) first = 0;
+
+    for(k = first; k < ser->intervals; ++k)
+        levels[k - first] = ser->levels[k % ser->capacity];
+
+    transfer[1] = ser->start + first * ser->dt;
+    transfer[2] = ser->dt;
+    return (int) (ser->intervals - first);
+}
+
+
+int timest_series_write(FILE *unit, int variable)
+{
+
+/* Write the retained time series of timest variable "variable" to binary file
+   "unit": the start time of the first interval and the interval length as two
+   doubles, the number of intervals as a long long, and then the interval
+   averages as floats, oldest first.  Returns the number of intervals
+   written. */
+
+    struct series *ser;
+    long   first, count, slot;
+    long long n;
+    double start;
+
+    if(!((variable >= 1) && (variable <= MAX_TVAR))) return 0;
+    ser = series[variable];
+    if(ser == NULL) return 0;
+
+    timest_update(variable);
+
+    first = ser->intervals - ser->capacity;
+    if(first < 0) first = 0;
+    count = ser->intervals - first;
+    start = ser->start + first * ser->dt;
+
+    fwrite(&start,   sizeof(double), 1, unit);
+    fwrite(&ser->dt, sizeof(double), 1, unit);
+    n = count;
+    fwrite(&n,       sizeof(long long), 1, unit);
+
+    /* The retained intervals occupy at most two runs of the ring buffer. */
+
+    slot = first % ser->capacity;
+    if(slot + count <= ser->capacity)
+        fwrite(&ser->levels[slot], sizeof(float), count, unit);
+    else {
+        fwrite(&ser->levels[slot], sizeof(float), ser->capacity - slot, unit);
+        fwrite(&ser->levels[0], sizeof(float), count - (ser->capacity - slot),
+               unit);
+    }
+    return (int) count;
+}
+
+
+void simlib_stats_snapshot(struct simlib_stats *snap)
+{
+
+/* Copy the statistics of every sampst and timest variable (including the list
+   lengths) into "snap".  The timest statistics are brought up to the current
+   simulation time in the copy only, so taking a snapshot does not disturb the
+   running accumulators. */
+
+    int ivar, list;
+
+    snap->time = sim_time;
+    for(ivar = 1; ivar <= MAX_SVAR; ++ivar)
+        snap->sampst[ivar] = sampst_stat[ivar];
+    for(ivar = 1; ivar <= MAX_TVAR; ++ivar) {
+        snap->timest[ivar] = timest_stat[ivar];
+        stat_accumulate(&snap->timest[ivar], preval[ivar],
+                        sim_time - tlvc[ivar]);
+    }
+    for(list = 0; list <= MAX_LIST; ++list)
+        snap->residence[list] = residence[list];
+}
+
+
+void simlib_stats_merge(struct simlib_stats *into, struct simlib_stats *from)
+{
+
+/* Merge every statistic of snapshot "from" into snapshot "into", e.g. to pool
+   independent replications. */
+
+    int ivar, list;
+
+    if(from->time > into->time) into->time = from->time;
+    for(ivar = 1; ivar <= MAX_SVAR; ++ivar)
+        stat_merge(&into->sampst[ivar], &from->sampst[ivar]);
+    for(ivar = 1; ivar <= MAX_TVAR; ++ivar)
+        stat_merge(&into->timest[ivar], &from->timest[ivar]);
+    for(list = 0; list <= MAX_LIST; ++list)
+        stat_merge(&into->residence[list], &from->residence[list]);
+}
+
+
 void out_sampst(FILE *unit, int lowvar, int highvar)
 {
 
@@ -648,6 +1350,8 @@ void pprint_out(FILE *unit, int i) /* Write ith entry in transfer to file
 float expon(float mean, int stream) /* Exponential variate generation
                                        function. */
 {
+    if (variates == VARIATE_ZIGGURAT && ziggurat_stream(stream))
+        return mean * ziggurat_expon(stream);
     return -mean * log(lcgrand(stream));
 
 }
@@ -667,117 +1371,2906 @@ int random_integer(float prob_distrib[], int stream) /* Discrete-variate
 }
 
 
-float uniform(float a, float b, int stream) /* Uniform variate generation
-                                               function. */
+struct discrete *discrete_build(float probs[], int n) /* Prepare the
+                                                         distribution with
+                                                         P(i) = probs[i],
+                                                         i = 1, ..., n, for
+                                                         discrete_sample. */
 {
-    return a + lcgrand(stream) * (b - a);
-}
+    struct discrete *dist;
+    double total, *scaled;
+    int    *small, *large, num_small, num_large, i, s, l;
+
+    total = 0.0;
+    for (i = 1; i <= n; ++i) {
+        if (probs[i] < 0.0) {
+            printf("\nNegative probability %f for outcome %d\n", probs[i], i);
+            exit(1);
+        }
+        total += probs[i];
+    }
+    if (n < 1 || total <= 0.0) {
+        printf("\nNo discrete distribution with %d outcomes\n", n);
+        exit(1);
+    }
 
+    dist   = (struct discrete *) malloc(sizeof(struct discrete));
+    scaled = (double *) malloc(n * sizeof(double));
+    small  = (int *) malloc(2 * n * sizeof(int));
+    if (dist != NULL) {
+        dist->cutoff = (double *) malloc(n * sizeof(double));
+        dist->alias  = (int *) malloc(n * sizeof(int));
+    }
+    if (dist == NULL || scaled == NULL || small == NULL ||
+        dist->cutoff == NULL || dist->alias == NULL) {
+        printf("\nOut of memory for a discrete distribution\n");
+        exit(1);
+    }
+    dist->n = n;
+    large   = small + n;
 
-float erlang(int m, float mean, int stream)  /* Erlang variate generation
-                                                function. */
+    /* Vose's method: scale so that the average column holds 1, then pair
+       each column below 1 with one above 1 that tops it up. */
+
+    num_small = num_large = 0;
+    for (i = 0; i < n; ++i) {
+        scaled[i] = probs[i + 1] * n / total;
+        if (scaled[i] < 1.0)
+            small[num_small++] = i;
+        else
+            large[num_large++] = i;
+    }
+    while (num_small > 0 && num_large > 0) {
+        s = small[--num_small];
+        l = large[--num_large];
+        dist->cutoff[s] = scaled[s];
+        dist->alias[s]  = l + 1;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0)
+            small[num_small++] = l;
+        else
+            large[num_large++] = l;
+    }
+
+    /* Whatever is left holds 1 up to rounding. */
+
+    while (num_large > 0) {
+        l = large[--num_large];
+        dist->cutoff[l] = 1.0;
+        dist->alias[l]  = l + 1;
+    }
+    while (num_small > 0) {
+        s = small[--num_small];
+        dist->cutoff[s] = 1.0;
+        dist->alias[s]  = s + 1;
+    }
+
+    free((char *)scaled);
+    free((char *)small);
+    return dist;
+}
+
+
+int discrete_sample(struct discrete *dist, int stream) /* Generate a variate
+                                                          from a distribution
+                                                          prepared by
+                                                          discrete_build. */
 {
-    int   i;
-    float mean_exponential, sum;
+    double u;
+    int    column;
+
+    /* One number, at the full resolution of the generator, picks the column
+       with its integer part and decides between the column and its alias
+       with its fractional part. */
+
+    u      = rng_uniform(stream) * dist->n;
+    column = (int) u;
+    if (column >= dist->n) column = dist->n - 1;
+    return (u - column < dist->cutoff[column]) ? column + 1
+                                               : dist->alias[column];
+}
+
+
+void discrete_free(struct discrete *dist) /* Release a distribution prepared
+                                             by discrete_build. */
+{
+    free((char *)dist->cutoff);
+    free((char *)dist->alias);
+    free((char *)dist);
+}
+
+
+float uniform(float a, float b, int stream) /* Uniform variate generation
+                                               function. */
+{
+    return a + lcgrand(stream) * (b - a);
+}
+
+
+/* Number of uniforms multiplied together before taking a log in erlang and
+   erlang_d; 16 numbers of at least 2^-53 cannot underflow a double. */
+
+#define ERLANG_CHUNK  16
+
+float erlang(int m, float mean, int stream)  /* Erlang variate generation
+                                                function. */
+{
+    int    i;
+    float  mean_exponential, sum;
+    double product;
 
     mean_exponential = mean / m;
     sum = 0.0;
-    for (i = 1; i <= m; ++i)
-        sum += expon(mean_exponential, stream);
+    if (variates == VARIATE_ZIGGURAT && ziggurat_stream(stream)) {
+        for (i = 1; i <= m; ++i)
+            sum += expon(mean_exponential, stream);
+        return sum;
+    }
+
+    /* The sum of m exponentials is -mean_exponential times the log of the
+       product of m uniforms, which needs one log per ERLANG_CHUNK
+       uniforms. */
+
+    for (i = 0; i < m; ) {
+        product = 1.0;
+        do
+            product *= lcgrand(stream);
+        while (++i % ERLANG_CHUNK != 0 && i < m);
+        sum += -mean_exponential * log(product);
+    }
     return sum;
 }
 
 
-/* Prime modulus multiplicative linear congruential generator
+double expon_d(double mean, int stream) /* Exponential variate generation
+                                           function, double precision. */
+{
+    if (variates == VARIATE_ZIGGURAT && ziggurat_stream(stream))
+        return mean * ziggurat_expon(stream);
+    return -mean * log(lcgrand_d(stream));
+}
 
-   Z[i] = (630360016 * Z[i-1]) (mod(pow(2,31) - 1)), based on Marse and
-   Roberts' portable FORTRAN random-number generator UNIRAN.  Multiple
-   (100) streams are supported, with seeds spaced 100,000 apart.
-   Throughout, input argument "stream" must be an int giving the
-   desired stream number.  The header file lcgrand.h must be included in
-   the calling program (#include "lcgrand.h") before using these
-   functions.
 
-   Usage: (Three functions)
+double uniform_d(double a, double b, int stream) /* Uniform variate generation
+                                                    function, double
+                                                    precision. */
+{
+    return a + lcgrand_d(stream) * (b - a);
+}
 
-   1. To obtain the next U(0,1) random number from stream "stream,"
-      execute
-          u = lcgrand(stream);
-      where lcgrand is a float function.  The float variable u will
-      contain the next random number.
 
-   2. To set the seed for stream "stream" to a desired value zset,
-      execute
-          lcgrandst(zset, stream);
-      where lcgrandst is a void function and zset must be a long set to
-      the desired seed, a number between 1 and 2147483646 (inclusive). 
-      Default seeds for all 100 streams are given in the code.
+double erlang_d(int m, double mean, int stream)  /* Erlang variate generation
+                                                    function, double
+                                                    precision. */
+{
+    int    i;
+    double mean_exponential, sum, product;
 
-   3. To get the current (most recently used) integer in the sequence
-      being generated for stream "stream" into the long variable zget,
-      execute
-          zget = lcgrandgt(stream);
-      where lcgrandgt is a long function. */
+    mean_exponential = mean / m;
+    sum = 0.0;
+    if (variates == VARIATE_ZIGGURAT && ziggurat_stream(stream)) {
+        for (i = 1; i <= m; ++i)
+            sum += expon_d(mean_exponential, stream);
+        return sum;
+    }
 
-/* Define the constants. */
+    for (i = 0; i < m; ) {                  /* As in erlang. */
+        product = 1.0;
+        do
+            product *= lcgrand_d(stream);
+        while (++i % ERLANG_CHUNK != 0 && i < m);
+        sum += -mean_exponential * log(product);
+    }
+    return sum;
+}
 
-#define MODLUS 2147483647
-#define MULT1       24112
-#define MULT2       26143
 
-/* Set the default seeds for all 100 streams. */
+static void gamma_setup(double alpha, double k[3])
+{
+    /* Work out the constants gamma_unit needs for shape alpha. */
 
-static long zrng[] =
-{         1,
- 1973272912, 281629770,  20006270,1280689831,2096730329,1933576050,
-  913566091, 246780520,1363774876, 604901985,1511192140,1259851944,
-  824064364, 150493284, 242708531,  75253171,1964472944,1202299975,
-  233217322,1911216000, 726370533, 403498145, 993232223,1103205531,
-  762430696,1922803170,1385516923,  76271663, 413682397, 726466604,
-  336157058,1432650381,1120463904, 595778810, 877722890,1046574445,
-   68911991,2088367019, 748545416, 622401386,2122378830, 640690903,
- 1774806513,2132545692,2079249579,  78130110, 852776735,1187867272,
- 1351423507,1645973084,1997049139, 922510944,2045512870, 898585771,
-  243649545,1004818771, 773686062, 403188473, 372279877,1901633463,
-  498067494,2087759558, 493157915, 597104727,1530940798,1814496276,
-  536444882,1663153658, 855503735,  67784357,1432404475, 619691088,
-  119025595, 880802310, 176192644,1116780070, 277854671,1366580350,
- 1142483975,2026948561,1053920743, 786262391,1792203830,1494667770,
- 1923011392,1433700034,1244184613,1147297105, 539712780,1545929719,
-  190641742,1645390429, 264907697, 620389253,1502074852, 927711160,
-  364849192,2049576050, 638580085, 547070247 };
+    if (alpha <= 0.0) {
+        printf("\n%f is an invalid gamma shape\n", alpha);
+        exit(1);
+    }
 
-/* Generate the next random number. */
+    k[2] = 0.0;
+    if (alpha < 1.0) {
+        k[2]   = 1.0 / alpha;
+        alpha += 1.0;
+    }
+    k[0] = alpha - 1.0 / 3.0;
+    k[1] = 1.0 / sqrt(9.0 * k[0]);
+}
 
-float lcgrand(int stream)
+
+static double gamma_unit(double k[3], int stream)
 {
-    long zi, lowprd, hi31;
+    /* Return a gamma variate with scale 1 and the shape alpha given to
+       gamma_setup, by the method of Marsaglia and Tsang ("A Simple Method for
+       Generating Gamma Variables", ACM TOMS 26, 2000): a transformed normal
+       accepted by a squeeze, which almost never needs a log.  For alpha < 1
+       a variate of shape alpha + 1 is scaled by U^(1 / alpha). */
+
+    double d, c, x, v, u, boost;
+
+    boost = (k[2] > 0.0) ? pow(lcgrand_d(stream), k[2]) : 1.0;
+    d = k[0];
+    c = k[1];
+    for (;;) {
+        do {
+            x = normal_d(0.0, 1.0, stream);
+            v = 1.0 + c * x;
+        } while (v <= 0.0);
+        v = v * v * v;
+        u = lcgrand_d(stream);
+        if (u < 1.0 - 0.0331 * (x * x) * (x * x) ||
+            log(u) < 0.5 * x * x + d * (1.0 - v + log(v)))
+            return boost * d * v;
+    }
+}
 
-    zi     = zrng[stream];
-    lowprd = (zi & 65535) * MULT1;
-    hi31   = (zi >> 16) * MULT1 + (lowprd >> 16);
-    zi     = ((lowprd & 65535) - MODLUS) +
-             ((hi31 & 32767) << 16) + (hi31 >> 15);
-    if (zi < 0) zi += MODLUS;
-    lowprd = (zi & 65535) * MULT2;
-    hi31   = (zi >> 16) * MULT2 + (lowprd >> 16);
-    zi     = ((lowprd & 65535) - MODLUS) +
-             ((hi31 & 32767) << 16) + (hi31 >> 15);
-    if (zi < 0) zi += MODLUS;
-    zrng[stream] = zi;
-    return (zi >> 7 | 1) / 16777216.0;
+
+float gamma_variate(float alpha, float mean, int stream) /* Gamma variate
+                                                            generation
+                                                            function. */
+{
+    return (float) gamma_variate_d(alpha, mean, stream);
 }
 
 
-void lcgrandst (long zset, int stream) /* Set the current zrng for stream
-                                          "stream" to zset. */
+double gamma_variate_d(double alpha, double mean, int stream) /* Gamma variate
+                                                                 generation
+                                                                 function,
+                                                                 double
+                                                                 precision. */
 {
-    zrng[stream] = zset;
+    double k[3];
+
+    gamma_setup(alpha, k);
+    return gamma_unit(k, stream) * mean / alpha;
 }
 
 
-long lcgrandgt (int stream) /* Return the current zrng for stream "stream". */
+void dist_init(struct distribution *dist, int type, double a, double b,
+               double c) /* Prepare a distribution of type "type" with
+                            parameters a, b and c (see simlibdefs.h). */
+{
+    double sigma2;
+
+    dist->type = type;
+    dist->a    = a;
+    dist->b    = b;
+    dist->c    = c;
+
+    switch (type) {
+        case DIST_NORMAL:
+            if (b < 0.0) break;
+            dist->k[0] = a;
+            dist->k[1] = b;
+            return;
+        case DIST_LOGNORMAL:
+            if (a <= 0.0 || b < 0.0) break;
+            sigma2     = log(1.0 + (b * b) / (a * a));
+            dist->k[0] = log(a) - 0.5 * sigma2;
+            dist->k[1] = sqrt(sigma2);
+            return;
+        case DIST_WEIBULL:
+            if (a <= 0.0 || b <= 0.0) break;
+            dist->k[0] = 1.0 / a;
+            dist->k[1] = b;
+            return;
+        case DIST_GAMMA:
+            if (a <= 0.0) break;
+            gamma_setup(a, dist->k);
+            dist->k[3] = b / a;
+            return;
+        case DIST_BETA:
+            if (a <= 0.0 || b <= 0.0) break;
+            gamma_setup(a, &dist->k[0]);
+            gamma_setup(b, &dist->k[3]);
+            return;
+        case DIST_TRIANGULAR:
+            if (!(a <= b && b <= c && a < c)) break;
+            dist->k[0] = (b - a) / (c - a);
+            dist->k[1] = sqrt((c - a) * (b - a));
+            dist->k[2] = sqrt((c - a) * (c - b));
+            return;
+        case DIST_PARETO:
+            if (a <= 0.0 || b <= 0.0) break;
+            dist->k[0] = -1.0 / a;
+            dist->k[1] = b;
+            return;
+    }
+
+    printf("\nInvalid distribution %d with parameters %f, %f, %f\n",
+           type, a, b, c);
+    exit(1);
+}
+
+
+double dist_sample(struct distribution *dist, int stream) /* Generate a
+                                                             variate from
+                                                             "dist". */
+{
+    double *k, u, g;
+
+    k = dist->k;
+    switch (dist->type) {
+        case DIST_NORMAL:
+            return normal_d(k[0], k[1], stream);
+        case DIST_LOGNORMAL:
+            return exp(normal_d(k[0], k[1], stream));
+        case DIST_WEIBULL:
+            return k[1] * pow(-log(lcgrand_d(stream)), k[0]);
+        case DIST_GAMMA:
+            return gamma_unit(k, stream) * k[3];
+        case DIST_BETA:
+            g = gamma_unit(&k[0], stream);
+            return g / (g + gamma_unit(&k[3], stream));
+        case DIST_TRIANGULAR:
+            u = lcgrand_d(stream);
+            if (u < k[0])
+                return dist->a + k[1] * sqrt(u);
+            return dist->c - k[2] * sqrt(1.0 - u);
+        case DIST_PARETO:
+            return k[1] * pow(lcgrand_d(stream), k[0]);
+    }
+
+    printf("\nInvalid distribution %d\n", dist->type);
+    exit(1);
+    return 0.0;
+}
+
+
+void dist_batch(struct distribution *dist, double out[], int n,
+                int stream) /* Fill out[0..n-1] with variates from
+                               "dist". */
+{
+    double *k, u, g;
+    int    i;
+
+    /* The switch is taken once per batch rather than once per variate. */
+
+    k = dist->k;
+    switch (dist->type) {
+        case DIST_NORMAL:
+            for (i = 0; i < n; ++i)
+                out[i] = normal_d(k[0], k[1], stream);
+            return;
+        case DIST_LOGNORMAL:
+            for (i = 0; i < n; ++i)
+                out[i] = exp(normal_d(k[0], k[1], stream));
+            return;
+        case DIST_WEIBULL:
+            for (i = 0; i < n; ++i)
+                out[i] = k[1] * pow(-log(lcgrand_d(stream)), k[0]);
+            return;
+        case DIST_GAMMA:
+            for (i = 0; i < n; ++i)
+                out[i] = gamma_unit(k, stream) * k[3];
+            return;
+        case DIST_BETA:
+            for (i = 0; i < n; ++i) {
+                g      = gamma_unit(&k[0], stream);
+                out[i] = g / (g + gamma_unit(&k[3], stream));
+            }
+            return;
+        case DIST_TRIANGULAR:
+            for (i = 0; i < n; ++i) {
+                u      = lcgrand_d(stream);
+                out[i] = (u < k[0]) ? dist->a + k[1] * sqrt(u)
+                                    : dist->c - k[2] * sqrt(1.0 - u);
+            }
+            return;
+        case DIST_PARETO:
+            for (i = 0; i < n; ++i)
+                out[i] = k[1] * pow(lcgrand_d(stream), k[0]);
+            return;
+    }
+
+    printf("\nInvalid distribution %d\n", dist->type);
+    exit(1);
+}
+
+
+/* Batch versions of expon, uniform and erlang.  They draw their numbers with
+   lcgrand_fill, in the order the scalar functions would, and take logs with
+   batch_log, a branch-free float approximation that the compiler can
+   vectorize; results agree with the scalar functions to within a few units
+   in the last place of a float.  Erlang variates take the logs of their m
+   numbers one at a time, which keeps the batch vectorizable and cannot
+   underflow.  Under VARIATE_ZIGGURAT, expon_batch and erlang_batch call
+   the scalar functions instead, so they give the same variates. */
+
+#define BATCH_CHUNK  256            /* Numbers per erlang_batch pass. */
+
+static void batch_log(float x[], int n)
+{
+    /* Replace each x[i] (positive and normal) by its natural log.  With
+       x = 2^e * f, f in [sqrt(1/2), sqrt(2)), log f = 2 atanh(s) where
+       s = (f - 1) / (f + 1), |s| < 0.172, summed to s^9. */
+
+    union { float f; unsigned int i; } bits;
+    float f, s, s2;
+    int   e, i, big;
+
+    for (i = 0; i < n; ++i) {
+        bits.f = x[i];
+        e      = (int) (bits.i >> 23) - 127;
+        bits.i = (bits.i & 0x007FFFFFU) | 0x3F800000U;
+        f      = bits.f;
+        big    = f > 1.41421356f;
+        f      = big ? 0.5f * f : f;
+        e     += big;
+        s      = (f - 1.0f) / (f + 1.0f);
+        s2     = s * s;
+        x[i]   = e * 0.693147181f
+                 + 2.0f * s * (1.0f + s2 * (0.333333333f + s2 * (0.2f
+                   + s2 * (0.142857143f + s2 * 0.111111111f))));
+    }
+}
+
+
+void expon_batch(float out[], int n, float mean, int stream)
+{
+    /* Fill out[0..n-1] with expon(mean, stream) variates. */
+
+    int i;
+
+    if (variates == VARIATE_ZIGGURAT) {
+        for (i = 0; i < n; ++i)
+            out[i] = expon(mean, stream);
+        return;
+    }
+
+    lcgrand_fill(stream, out, n);
+    batch_log(out, n);
+    for (i = 0; i < n; ++i)
+        out[i] *= -mean;
+}
+
+
+void uniform_batch(float out[], int n, float a, float b, int stream)
+{
+    /* Fill out[0..n-1] with uniform(a, b, stream) variates. */
+
+    int i;
+
+    lcgrand_fill(stream, out, n);
+    for (i = 0; i < n; ++i)
+        out[i] = a + out[i] * (b - a);
+}
+
+
+void erlang_batch(float out[], int n, int m, float mean, int stream)
+{
+    /* Fill out[0..n-1] with erlang(m, mean, stream) variates. */
+
+    float u[BATCH_CHUNK];
+    long  left;
+    int   i, j, k, count;
+
+    if (variates == VARIATE_ZIGGURAT) {
+        for (i = 0; i < n; ++i)
+            out[i] = erlang(m, mean, stream);
+        return;
+    }
+
+    for (i = 0; i < n; ++i)
+        out[i] = 0.0;
+
+    /* Variate i sums the logs of numbers i * m, ..., i * m + m - 1; count is
+       how many of them it has so far. */
+
+    i = count = 0;
+    for (left = (long) n * m; left > 0; left -= k) {
+        k = (left < BATCH_CHUNK) ? (int) left : BATCH_CHUNK;
+        lcgrand_fill(stream, u, k);
+        batch_log(u, k);
+        for (j = 0; j < k; ++j) {
+            out[i] += u[j];
+            if (++count == m) {
+                ++i;
+                count = 0;
+            }
+        }
+    }
+    for (i = 0; i < n; ++i)
+        out[i] *= -mean / m;
+}
+
+
+/* Empirical distributions (Law and Kelton's continuous empirical
+   distribution): with the n sorted values x[0], ..., x[n-1] taken as the
+   quantiles at 0, 1 / (n - 1), ..., 1, the inverse distribution function is
+   linear between them, so a sample is one index computation and one
+   interpolation whatever n is.  The file is converted once by
+   empirical_write and then loaded without parsing; mapped read-only and
+   shared, it is paged in on demand and kept once in memory however many
+   replications or processes load it. */
+
+#define EMPIRICAL_HEADER  (8 + sizeof(long long))
+
+static char *file_share(char *path, size_t *size, int *mapped)
+{
+    /* Return the contents of file "path" and their length in *size: a
+       read-only shared mapping (*mapped nonzero) where possible, else a copy
+       read into the heap.  Return NULL if the file cannot be read. */
+
+    FILE *file;
+    char *data;
+    long length;
+#ifdef SIMLIB_MMAP
+    struct stat info;
+    int    fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd >= 0) {
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            *size = (size_t) info.st_size;
+            data  = (char *) mmap(NULL, *size, PROT_READ, MAP_SHARED, fd, 0);
+            if (data != (char *) MAP_FAILED) {
+                close(fd);
+                *mapped = 1;
+                return data;
+            }
+        }
+        close(fd);
+    }
+#endif
+
+    /* Read the file where it cannot be mapped. */
+
+    file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+    if (fseek(file, 0L, SEEK_END) != 0 || (length = ftell(file)) <= 0) {
+        fclose(file);
+        return NULL;
+    }
+    *size = (size_t) length;
+
+    *mapped = 0;
+    data    = (char *) malloc(*size);
+    if (data == NULL || fseek(file, 0L, SEEK_SET) != 0 ||
+        fread(data, 1, *size, file) != *size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    return data;
+}
+
+
+static void file_unshare(char *data, size_t size, int mapped)
+{
+    /* Release contents returned by file_share. */
+
+#ifdef SIMLIB_MMAP
+    if (mapped) {
+        munmap(data, size);
+        return;
+    }
+#endif
+    free(data);
+}
+
+
+static int empirical_compare(const void *a, const void *b)
+{
+    /* Order doubles for qsort. */
+
+    double x = *(const double *) a, y = *(const double *) b;
+
+    return (x < y) ? -1 : (x > y);
+}
+
+
+void empirical_write(char *path, double values[], long n) /* Sort values[0..n-1]
+                                                             into an empirical
+                                                             file "path". */
+{
+    FILE   *file;
+    double *sorted;
+    long long count;
+
+    sorted = (double *) malloc((n > 0 ? n : 1) * sizeof(double));
+    if (n < 1 || sorted == NULL) {
+        printf("\nCannot write %ld values to empirical file %s\n", n, path);
+        exit(1);
+    }
+    memcpy(sorted, values, n * sizeof(double));
+    qsort(sorted, n, sizeof(double), empirical_compare);
+
+    count = n;
+    file  = fopen(path, "wb");
+    if (file == NULL ||
+        fwrite(EMPIRICAL_MAGIC, 1, 8, file) != 8 ||
+        fwrite(&count, sizeof(count), 1, file) != 1 ||
+        fwrite(sorted, sizeof(double), n, file) != (size_t) n ||
+        fclose(file) != 0) {
+        printf("\nCannot write empirical file %s\n", path);
+        exit(1);
+    }
+    free((char *)sorted);
+}
+
+
+struct empirical *empirical_load(char *path) /* Load the empirical file
+                                                "path". */
+{
+    struct empirical *emp;
+    long long count;
+
+    emp = (struct empirical *) malloc(sizeof(struct empirical));
+    if (emp == NULL ||
+        (emp->file = file_share(path, &emp->size, &emp->mapped)) == NULL ||
+        emp->size < EMPIRICAL_HEADER ||
+        memcmp(emp->file, EMPIRICAL_MAGIC, 8) != 0) {
+        printf("\nCannot load empirical file %s\n", path);
+        exit(1);
+    }
+    memcpy(&count, emp->file + 8, sizeof(count));
+    if (count < 1 ||
+        (emp->size - EMPIRICAL_HEADER) / sizeof(double) != (size_t) count) {
+        printf("\nEmpirical file %s is truncated\n", path);
+        exit(1);
+    }
+    emp->n = (long) count;
+    emp->x = (double *) (emp->file + EMPIRICAL_HEADER);
+    return emp;
+}
+
+
+double empirical_sample(struct empirical *emp, int stream) /* Generate a
+                                                              variate from an
+                                                              empirical
+                                                              distribution. */
+{
+    double u;
+    long   i;
+
+    if (emp->n == 1) return emp->x[0];
+
+    u  = lcgrand_d(stream) * (emp->n - 1);
+    i  = (long) u;
+    if (i >= emp->n - 1) i = emp->n - 2;
+    return emp->x[i] + (u - i) * (emp->x[i + 1] - emp->x[i]);
+}
+
+
+void empirical_free(struct empirical *emp) /* Release an empirical
+                                              distribution. */
+{
+    file_unshare(emp->file, emp->size, emp->mapped);
+    free((char *)emp);
+}
+
+
+/* Trace-driven arrivals.  trace_convert turns a CSV file of arrivals, one
+   per line as "time,attribute,attribute,...", into a trace file, reading the
+   CSV in large blocks and converting plain decimals directly (no fscanf).
+   trace_open shares the trace file like empirical_load, and
+   trace_schedule(tr, type) schedules an event of type "type" at the time of
+   the next record, with its attributes in attributes 3, 4, ... of the event
+   record (so maxatr must be at least nattr + 2).  Record times are taken
+   relative to the first record, whose time trace_open keeps in tr->origin:
+   simulation time 0 is the first arrival, and record time t is scheduled at
+   t - tr->origin.  Event times are floats, so absolute timestamps (seconds
+   since 1970, say) would otherwise run arrivals up to two minutes apart
+   together; even rebased, a trace spanning more than about 2^24 time units
+   resolves to less than a unit by its end.  Calling trace_schedule once at
+   the start and again from the arrival event keeps just one trace
+   arrival in the event list at a time. */
+
+#define TRACE_HEADER  (8 + 2 * sizeof(long long))
+#define TRACE_BLOCK   1048576       /* Bytes of CSV read at a time. */
+
+static double trace_number(char *s, char **end)
+{
+    /* Convert the number at s like strtod, but without skipping newlines.
+       Plain decimals with at most 2^53 as their digits and 22 decimal
+       places are converted directly (one exact division, so correctly
+       rounded); anything else goes to strtod. */
+
+    static double tens[23] = {1E0, 1E1, 1E2, 1E3, 1E4, 1E5, 1E6, 1E7, 1E8,
+                              1E9, 1E10, 1E11, 1E12, 1E13, 1E14, 1E15, 1E16,
+                              1E17, 1E18, 1E19, 1E20, 1E21, 1E22};
+    unsigned long long digits;
+    char   *p, *first;
+    int    negative, places;
+
+    for (p = s; *p == ' ' || *p == '\t'; ++p)
+        ;
+    negative = (*p == '-');
+    if (*p == '-' || *p == '+') ++p;
+
+    digits = 0;
+    places = 0;
+    first  = p;
+    for (; *p >= '0' && *p <= '9'; ++p) {
+        digits = digits * 10 + (*p - '0');
+        if (digits > 9007199254740992ULL) return strtod(s, end);
+    }
+    if (*p == '.')
+        for (++p; *p >= '0' && *p <= '9'; ++p) {
+            digits = digits * 10 + (*p - '0');
+            if (digits > 9007199254740992ULL || ++places > 22)
+                return strtod(s, end);
+        }
+    if (*first == '\n' || *first == '\r' || *first == '\0') {
+        *end = s;                           /* No number. */
+        return 0.0;
+    }
+    if (p == first || (p == first + 1 && *first == '.') ||
+        *p == 'e' || *p == 'E' || *p == 'x' || *p == 'X')
+        return strtod(s, end);              /* Exponent, inf, hex, ... */
+
+    *end = p;
+    return (negative ? -1.0 : 1.0) * (double) digits / tens[places];
+}
+
+
+static void trace_write_header(FILE *file, long long n, long long nattr)
+{
+    /* Write the header of a trace file with n records of nattr
+       attributes. */
+
+    fseek(file, 0L, SEEK_SET);
+    fwrite(TRACE_MAGIC, 1, 8, file);
+    fwrite(&n, sizeof(n), 1, file);
+    fwrite(&nattr, sizeof(nattr), 1, file);
+}
+
+
+long trace_convert(char *csv_path, char *trace_path) /* Convert a CSV trace to
+                                                        a binary one; return
+                                                        the number of
+                                                        records. */
 {
-    return zrng[stream];
+    FILE   *in, *out;
+    char   *block, *p, *end, *line_end, *next, *start;
+    double value, last_time, rec[MAX_ATTR + 1];
+    size_t have, got;
+    long   n;
+    int    nattr, field;
+
+    in    = fopen(csv_path, "rb");
+    out   = fopen(trace_path, "wb");
+    block = (char *) malloc(TRACE_BLOCK + 1);
+    if (in == NULL || out == NULL || block == NULL) {
+        printf("\nCannot convert trace %s to %s\n", csv_path, trace_path);
+        exit(1);
+    }
+    trace_write_header(out, 0, 0);
+
+    n         = 0;
+    nattr     = -1;                 /* Set by the first record. */
+    last_time = -1E30;
+    have      = 0;
+    for (;;) {
+        got  = fread(block + have, 1, TRACE_BLOCK - have, in);
+        have += got;
+        if (have == 0) break;
+        block[have] = '\0';
+
+        /* Convert every complete line in the block (all of it at the end of
+           the file), then move any partial line to the front. */
+
+        end = block + have;
+        if (got > 0) {
+            for (line_end = end; line_end > block && line_end[-1] != '\n';
+                 --line_end)
+                ;
+            if (line_end == block && have == TRACE_BLOCK) {
+                printf("\nLine too long in trace %s\n", csv_path);
+                exit(1);
+            }
+            end = line_end;
+        }
+
+        for (p = block; p < end; p = line_end + 1) {
+            for (line_end = p; line_end < end && *line_end != '\n';
+                 ++line_end)
+                ;
+            for (next = p; next < line_end && isspace((unsigned char) *next);
+                 ++next)
+                ;
+            if (next == line_end) continue;          /* Blank line. */
+
+            /* Each field must hold a number; a first line that does not
+               start with one is taken as a heading and skipped. */
+
+            field = 0;
+            for (;;) {
+                start = next;
+                value = trace_number(start, &next);
+                if (next == start || next > line_end) break;
+                if (field <= MAX_ATTR) rec[field] = value;
+                ++field;
+                while (next < line_end && isspace((unsigned char) *next))
+                    ++next;
+                if (next >= line_end || *next != ',') break;
+                ++next;
+            }
+            if (field == 0 && nattr == -1) {
+                nattr = -2;                         /* Heading skipped. */
+                continue;
+            }
+            if (nattr < 0) nattr = field - 1;
+            if (field == 0 || field - 1 != nattr || nattr > MAX_ATTR - 2 ||
+                next != line_end || rec[0] < last_time) {
+                printf("\nBad record %ld in trace %s\n", n + 1, csv_path);
+                exit(1);
+            }
+            last_time = rec[0];
+            fwrite(rec, sizeof(double), nattr + 1, out);
+            ++n;
+        }
+
+        if (got == 0) break;
+        have -= end - block;
+        memmove(block, end, have);
+    }
+
+    trace_write_header(out, n, nattr < 0 ? 0 : nattr);
+    if (ferror(in) || ferror(out) || fclose(out) != 0) {
+        printf("\nCannot convert trace %s to %s\n", csv_path, trace_path);
+        exit(1);
+    }
+    fclose(in);
+    free(block);
+    return n;
 }
 
+
+struct trace *trace_open(char *path) /* Open the trace file "path" at its
+                                        first record. */
+{
+    struct trace *tr;
+    long long count[2];
+
+    tr = (struct trace *) malloc(sizeof(struct trace));
+    if (tr == NULL ||
+        (tr->file = file_share(path, &tr->size, &tr->mapped)) == NULL ||
+        tr->size < TRACE_HEADER || memcmp(tr->file, TRACE_MAGIC, 8) != 0) {
+        printf("\nCannot open trace file %s\n", path);
+        exit(1);
+    }
+    memcpy(count, tr->file + 8, sizeof(count));
+    if (count[0] < 0 || count[1] < 0 || count[1] > MAX_ATTR - 2 ||
+        (tr->size - TRACE_HEADER) / sizeof(double)
+            != (size_t) (count[0] * (count[1] + 1))) {
+        printf("\nTrace file %s is truncated\n", path);
+        exit(1);
+    }
+    tr->n     = (long) count[0];
+    tr->nattr = (int) count[1];
+    tr->next  = 0;
+    tr->rec   = (double *) (tr->file + TRACE_HEADER);
+    tr->origin = (tr->n > 0) ? tr->rec[0] : 0.0;
+    return tr;
+}
+
+
+int trace_schedule(struct trace *tr, int type_of_event) /* Schedule the next
+                                                           arrival of trace
+                                                           "tr"; return 0 at
+                                                           the end. */
+{
+    double *rec;
+    int    i;
+
+    if (tr->next >= tr->n) return 0;
+    if (maxatr < tr->nattr + 2) {
+        printf("\nmaxatr must be at least %d for this trace\n",
+               tr->nattr + 2);
+        exit(1);
+    }
+
+    rec = tr->rec + tr->next++ * (tr->nattr + 1);
+    for (i = 1; i <= tr->nattr; ++i)
+        transfer[i + 2] = rec[i];
+    event_schedule((float) (rec[0] - tr->origin), type_of_event);
+    return 1;
+}
+
+
+void trace_close(struct trace *tr) /* Release trace "tr". */
+{
+    file_unshare(tr->file, tr->size, tr->mapped);
+    free((char *)tr);
+}
+
+
+/* Nonhomogeneous Poisson arrivals by inversion of the cumulative rate
+   function (Law and Kelton): with Lambda(t) the expected number of
+   arrivals by time t, the next arrival after one at Lambda = L comes at
+   Lambda^-1(L + E), E exponential with mean 1.  Lambda is piecewise linear,
+   tabulated at the piece starts once by nhpp_build, and a cursor remembers
+   the piece of the last arrival, so each arrival costs O(1) on average and
+   the rate changes need no events.  A profile with a period repeats (a daily
+   profile, say); one without keeps its last rate forever. */
+
+struct nhpp *nhpp_build(float start[], float rate[], int n,
+                        float period) /* Build the arrival process with rate
+                                         rate[i] from time start[i] on,
+                                         i = 0, ..., n - 1. */
+{
+    struct nhpp *arrivals;
+    int    i;
+
+    if (n < 1 || start[0] != 0.0 || (period > 0.0 && period <= start[n - 1])) {
+        printf("\nInvalid rate profile of %d pieces\n", n);
+        exit(1);
+    }
+    for (i = 0; i < n; ++i)
+        if (rate[i] < 0.0 || (i > 0 && start[i] <= start[i - 1])) {
+            printf("\nInvalid piece %d of a rate profile\n", i);
+            exit(1);
+        }
+
+    arrivals = (struct nhpp *) malloc(sizeof(struct nhpp));
+    if (arrivals != NULL) {
+        arrivals->start = (double *) malloc((n + 1) * sizeof(double));
+        arrivals->rate  = (double *) malloc(n * sizeof(double));
+        arrivals->cum   = (double *) malloc((n + 1) * sizeof(double));
+    }
+    if (arrivals == NULL || arrivals->start == NULL ||
+        arrivals->rate == NULL || arrivals->cum == NULL) {
+        printf("\nOut of memory for a rate profile\n");
+        exit(1);
+    }
+
+    arrivals->n      = n;
+    arrivals->period = (period > 0.0) ? period : 0.0;
+    arrivals->cum[0] = 0.0;
+    for (i = 0; i < n; ++i) {
+        arrivals->start[i] = start[i];
+        arrivals->rate[i]  = rate[i];
+    }
+    arrivals->start[n] = (period > 0.0) ? period : 1E30;
+    for (i = 0; i < n; ++i)
+        arrivals->cum[i + 1] = arrivals->cum[i] + arrivals->rate[i]
+                               * (arrivals->start[i + 1] - arrivals->start[i]);
+    if (period > 0.0 && arrivals->cum[n] <= 0.0) {
+        printf("\nRate profile has no arrivals\n");
+        exit(1);
+    }
+
+    nhpp_reset(arrivals);
+    return arrivals;
+}
+
+
+float nhpp_next(struct nhpp *arrivals, int stream) /* Return the time of the
+                                                      next arrival (1E30 if
+                                                      there is none). */
+{
+    double target, total;
+    long   cycle;
+    int    i, n;
+
+    n      = arrivals->n;
+    total  = arrivals->cum[n];
+    target = arrivals->lambda + expon_d(1.0, stream);
+    arrivals->lambda = target;
+
+    /* Find the period and then, from the cursor, the piece holding the
+       target. */
+
+    cycle = 0;
+    if (arrivals->period > 0.0) {
+        cycle   = (long) floor(target / total);
+        target -= cycle * total;
+        if (cycle != arrivals->cycle) {
+            arrivals->cycle = cycle;
+            arrivals->piece = 0;
+        }
+    }
+    for (i = arrivals->piece; i < n - 1 && arrivals->cum[i + 1] <= target; ++i)
+        ;
+    arrivals->piece = i;
+
+    if (arrivals->rate[i] <= 0.0)           /* Last piece, rate 0. */
+        return 1E30;
+    return cycle * arrivals->period + arrivals->start[i]
+           + (target - arrivals->cum[i]) / arrivals->rate[i];
+}
+
+
+void nhpp_reset(struct nhpp *arrivals) /* Restart the arrival process at
+                                          time 0. */
+{
+    arrivals->lambda = 0.0;
+    arrivals->cycle  = 0;
+    arrivals->piece  = 0;
+}
+
+
+void nhpp_free(struct nhpp *arrivals) /* Release an arrival process. */
+{
+    free((char *)arrivals->start);
+    free((char *)arrivals->rate);
+    free((char *)arrivals->cum);
+    free((char *)arrivals);
+}
+
+
+static double normal_quantile(double p)
+{
+    /* Return the standard normal quantile of p, 0 < p < 1, by Acklam's
+       rational approximation (relative error below 1.2E-9) polished by one
+       Halley step. */
+
+    static double a[6] = {-3.969683028665376e+01,  2.209460984245205e+02,
+                          -2.759285104469687e+02,  1.383577518672690e+02,
+                          -3.066479806614716e+01,  2.506628277459239e+00};
+    static double b[5] = {-5.447609879822406e+01,  1.615858368580409e+02,
+                          -1.556989798598866e+02,  6.680131188771972e+01,
+                          -1.328068155288572e+01};
+    static double c[6] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                          -2.400758277161838e+00, -2.549732539343734e+00,
+                           4.374664141464968e+00,  2.938163982698783e+00};
+    static double d[4] = { 7.784695709041462e-03,  3.224671290700398e-01,
+                           2.445134137142996e+00,  3.754408661907416e+00};
+    double q, r, x, e;
+
+    if (p < 0.02425 || p > 1.0 - 0.02425) {     /* Tails. */
+        q = sqrt(-2.0 * log(p < 0.5 ? p : 1.0 - p));
+        x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q
+             + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+        if (p > 0.5) x = -x;
+    }
+    else {                                      /* Central region. */
+        q = p - 0.5;
+        r = q * q;
+        x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r
+             + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r
+                            + b[4]) * r + 1.0);
+    }
+
+    e = 0.5 * erfc(-x / sqrt(2.0)) - p;
+    r = e * 2.506628274631000 * exp(0.5 * x * x);   /* sqrt(2 pi). */
+    return x - r / (1.0 + 0.5 * x * r);
+}
+
+
+float normal(float mu, float sigma, int stream) /* Normal variate generation
+                                                   function. */
+{
+    if (variates == VARIATE_ZIGGURAT && ziggurat_stream(stream))
+        return mu + sigma * ziggurat_normal(stream);
+    return mu + sigma * normal_quantile(lcgrand(stream));
+}
+
+
+double normal_d(double mu, double sigma, int stream) /* Normal variate
+                                                        generation function,
+                                                        double precision. */
+{
+    if (variates == VARIATE_ZIGGURAT && ziggurat_stream(stream))
+        return mu + sigma * ziggurat_normal(stream);
+    return mu + sigma * normal_quantile(lcgrand_d(stream));
+}
+
+
+/* Prime modulus multiplicative linear congruential generator
+
+   Z[i] = (630360016 * Z[i-1]) (mod(pow(2,31) - 1)), based on Marse and
+   Roberts' portable FORTRAN random-number generator UNIRAN.  Any number of
+   streams is supported, with seeds spaced 100,000 apart; the stream table
+   grows on demand the first time a stream is used.
+   Throughout, input argument "stream" must be an int giving the
+   desired stream number.  The header file lcgrand.h must be included in
+   the calling program (#include "lcgrand.h") before using these
+   functions.
+
+   Usage: (Three functions)
+
+   1. To obtain the next U(0,1) random number from stream "stream,"
+      execute
+          u = lcgrand(stream);
+      where lcgrand is a float function.  The float variable u will
+      contain the next random number.
+
+   2. To set the seed for stream "stream" to a desired value zset,
+      execute
+          lcgrandst(zset, stream);
+      where lcgrandst is a void function and zset must be a long set to
+      the desired seed, a number between 1 and 2147483646 (inclusive). 
+      Default seeds for the first 100 streams are given in the code; the
+      default seed of any later stream is derived from them by jump-ahead.
+
+   3. To get the current (most recently used) integer in the sequence
+      being generated for stream "stream" into the long variable zget,
+      execute
+          zget = lcgrandgt(stream);
+      where lcgrandgt is a long function.  (Under the MRG32k3a and Philox
+      backends below, the two functions set and get the position of the
+      stream rather than a seed.)
+
+   Bulk generation: (One more function)
+
+   To fill u[0], ..., u[n-1] with the next n U(0,1) random numbers from
+   stream "stream", exactly as n calls of lcgrand would, execute
+          lcgrand_fill(stream, u, n);
+   To have lcgrand serve stream "stream" from a buffer of "size" numbers
+   that is refilled by lcgrand_fill whenever it runs dry, execute
+          lcgrand_buffer(stream, size);
+   (size 0 turns buffering off).  Buffering never changes the sequence: a
+   stream that is reseeded, queried, jumped or filled is first rewound to the
+   last number actually used.
+
+   Double precision: (One more function)
+
+   To obtain the next U(0,1) random number from stream "stream" with 53-bit
+   rather than 24-bit resolution, execute
+          u = lcgrand_d(stream);
+   where lcgrand_d is a double function that uses two numbers of the
+   stream.  expon_d, uniform_d and erlang_d are the matching variate
+   functions.  Under the MRG32k3a and Philox backends expon_d reaches about
+   36.7 means instead of 16.6; under the LCG the two numbers are successive
+   states of one generator, so there are at most 2^31 distinct values and
+   expon_d reaches only about 21.8 means.
+
+   Antithetic variates: (Two more functions)
+
+   To have stream "stream" return 1 - u in place of each number u (on
+   nonzero), or u again (on zero), execute
+          lcgrand_set_antithetic(stream, on);
+   This carries over to lcgrand_d, lcgrand_fill and every variate function.
+   To run a model as an antithetic pair, write it as a function
+   model(est) that initializes simlib, simulates, and puts n estimates in
+   est[0], ..., est[n-1], and execute
+          simlib_antithetic(model, n, est);
+   which runs the model from the current stream states with plain and then
+   with antithetic streams and returns the n pair averages in est.  For
+   models whose outputs are monotone in their inputs (queues like
+   mm1smlb.c, for example) the two runs are negatively correlated, and the
+   average has a smaller variance than that of two independent runs.  The
+   ziggurat cannot be paired this way (see the ziggurat below), so both runs
+   use the inverse transform whatever the variate method, and the model must
+   not select VARIATE_ZIGGURAT itself.
+
+   Common random numbers: (Two more functions)
+
+   To compare configurations of a model under the same random inputs,
+   execute
+          lcgrand_crn(rep);
+   before simulating each configuration.  It restarts every stream at the
+   start of its substream for replication rep (see lcgrand_substream below),
+   so that each configuration of replication rep sees the same numbers
+   whatever the earlier configurations consumed; Sobol streams (see below)
+   go back to their first point.  Under the LCG backend only
+   streams 1 through LCG_STREAMS have substreams, so a model using higher
+   streams needs the MRG32k3a or Philox backend.  For inputs that belong to
+   an entity, such as the interarrival and service times of customer k,
+   execute
+          lcgrand_entity(stream, k);
+   before drawing them, so that customer k gets the same numbers in every
+   configuration even when customers draw in a different order.  Entity
+   substreams need the MRG32k3a backend (2^40 numbers for each of 2^36
+   entities) or the Philox backend.
+
+   Quasi-random streams: (One more function)
+
+   To serve stream "stream" from a randomly scrambled Sobol sequence of dims
+   dimensions (1 to SOBOL_MAX_DIMS) rather than from its generator, execute
+          lcgrand_sobol(stream, dims);
+   Successive numbers are coordinates 1, ..., dims of one point, then of the
+   next point, so a model that draws dims numbers from the stream per
+   replication (or per customer) gets a low-discrepancy sample of the unit
+   cube, through expon, uniform and the other variate functions alike.  The
+   scramble is drawn from the generator of the stream, so independent
+   replications (after lcgrand_substream, say) call lcgrand_sobol again;
+   dims 0 goes back to the generator.  A Sobol stream returns 32-bit numbers,
+   also from lcgrand_d.
+
+   Jump-ahead: (Two more functions)
+
+   4. To advance stream "stream" by k numbers in O(log k) steps, as if lcgrand
+      had been called k times, execute
+          lcgrand_jump(stream, k);
+
+   5. To position stream "stream" at the start of the block of numbers
+      reserved for replication rep = 0, 1, ..., execute
+          lcgrand_substream(stream, rep);
+      The period is carved into blocks of LCG_SUBSTREAM_LENGTH numbers,
+      starting from the seed of stream 1; block rep * LCG_STREAMS + stream - 1
+      belongs to the pair (stream, rep), so no two pairs can overlap as long as
+      no replication draws more than LCG_SUBSTREAM_LENGTH numbers from a
+      stream.  The period holds replications 0 through 19 of streams 1 through
+      LCG_STREAMS; longer runs, more replications and more streams need the
+      MRG32k3a backend below. */
+
+/* Define the constants. */
+
+#define MODLUS 2147483647
+#define MULT1       24112
+#define MULT2       26143
+#define MULT   630360016            /* MULT1 * MULT2 (mod MODLUS). */
+#define LCG_STREAMS               100
+#define LCG_SUBSTREAM_LENGTH  1048576   /* 2^20 numbers per block. */
+#define LCG_LANES                   8   /* Interleaved states in lcgrand_fill. */
+#define LCG_FILL_CHUNK            256   /* Numbers per lcgrand_fill pass. */
+
+/* Set the default seeds for the first 100 streams. */
+
+static long zrng_default[] =
+{         1,
+ 1973272912, 281629770,  20006270,1280689831,2096730329,1933576050,
+  913566091, 246780520,1363774876, 604901985,1511192140,1259851944,
+  824064364, 150493284, 242708531,  75253171,1964472944,1202299975,
+  233217322,1911216000, 726370533, 403498145, 993232223,1103205531,
+  762430696,1922803170,1385516923,  76271663, 413682397, 726466604,
+  336157058,1432650381,1120463904, 595778810, 877722890,1046574445,
+   68911991,2088367019, 748545416, 622401386,2122378830, 640690903,
+ 1774806513,2132545692,2079249579,  78130110, 852776735,1187867272,
+ 1351423507,1645973084,1997049139, 922510944,2045512870, 898585771,
+  243649545,1004818771, 773686062, 403188473, 372279877,1901633463,
+  498067494,2087759558, 493157915, 597104727,1530940798,1814496276,
+  536444882,1663153658, 855503735,  67784357,1432404475, 619691088,
+  119025595, 880802310, 176192644,1116780070, 277854671,1366580350,
+ 1142483975,2026948561,1053920743, 786262391,1792203830,1494667770,
+ 1923011392,1433700034,1244184613,1147297105, 539712780,1545929719,
+  190641742,1645390429, 264907697, 620389253,1502074852, 927711160,
+  364849192,2049576050, 638580085, 547070247 };
+
+
+static long lcg_multmod(long a, long z) /* Return a * z (mod MODLUS). */
+{
+    unsigned long long product;
+
+    /* Since MODLUS = 2^31 - 1, 2^31 = 1 (mod MODLUS), so the high bits of the
+       product can be folded onto the low bits. */
+
+    product = (unsigned long long) a * (unsigned long long) z;
+    product = (product & MODLUS) + (product >> 31);
+    if (product >= MODLUS) product -= MODLUS;
+    return (long) product;
+}
+
+
+static long lcg_power(long k) /* Return MULT^k (mod MODLUS), k >= 0. */
+{
+    long power, square;
+
+    power  = 1;
+    square = MULT;
+    for (k %= MODLUS - 1; k > 0; k >>= 1) {
+        if (k & 1) power = lcg_multmod(power, square);
+        square = lcg_multmod(square, square);
+    }
+    return power;
+}
+
+/* Combined multiple recursive generator MRG32k3a (L'Ecuyer, "Good Parameters
+   and Implementations for Combined Multiple Recursive Random Number
+   Generators", Operations Research 47, 1999), an alternative backend behind
+   lcgrand, lcgrandst, lcgrandgt, lcgrand_jump and lcgrand_substream with a
+   period of about 2^191.  It is selected by
+          lcgrand_backend(RNG_MRG32K3A);
+   which (re)starts every stream; stream s starts s * 2^127 numbers after the
+   seed (12345, ..., 12345), replication rep of a stream
+   (lcgrand_substream) starts rep * 2^76 numbers after the stream start, and
+   entity e of a replication (lcgrand_entity) starts e * 2^40 numbers after
+   the replication start.
+   As the six-component state does not fit in a long, lcgrandst and
+   lcgrandgt work with the position of the stream instead, as under Philox:
+   lcgrandgt(stream) returns how many numbers the stream has handed out
+   since the start of its current substream (or entity), and
+   lcgrandst(zset, stream) puts it back at position zset >= 0 of that
+   substream, so that lcgrandst(lcgrandgt(stream), stream) restores it. */
+
+#define MRG_M1    4294967087LL
+#define MRG_M2    4294944443LL
+#define MRG_A12      1403580LL
+#define MRG_A13N      810728LL
+#define MRG_A21       527612LL
+#define MRG_A23N     1370589LL
+#define MRG_NORM  2.328306549295727688e-10  /* 1 / (MRG_M1 + 1). */
+#define MRG_ENTITIES  68719476736LL         /* 2^36 entities per substream. */
+
+/* State of every stream under all backends, two cache lines per stream so
+   that streams driven from different threads do not share lines.  rng points
+   into rng_block, an allocation padded so that rng can be line-aligned. */
+
+#define RNG_LINE_SIZE  64
+
+struct rng_state {
+    long      z;                /* LCG state. */
+    long long mrg[6];           /* MRG32k3a state. */
+    struct rng_buffer *buffer;  /* Set by lcgrand_buffer, else NULL. */
+    unsigned int key[2];        /* Philox key, from (rep, stream). */
+    unsigned int out[4];        /* Philox block number "block". */
+    unsigned long long block;   /* Block in out, or PHILOX_NONE. */
+    unsigned long long entity;  /* Entity (lcgrand_entity). */
+    unsigned long long draw;    /* Philox index of the next number. */
+    int       rep;              /* Replication (lcgrand_substream). */
+    int       antithetic;       /* Nonzero to return 1 - u instead of u. */
+    struct rng_sobol *sobol;    /* Set by lcgrand_sobol, else NULL. */
+};
+
+struct rng_buffer {
+    struct rng_state start;     /* Stream state before the last refill. */
+    int    size;                /* Capacity of u. */
+    int    count;               /* Numbers in u. */
+    int    next;                /* Index in u of the next number to use. */
+    double *u;                  /* Buffered numbers at full resolution. */
+};
+
+static SIMLIB_THREAD union rng_slot {
+    struct rng_state st;
+    char             line[2 * RNG_LINE_SIZE];
+} *rng;
+
+static SIMLIB_THREAD char *rng_block;
+static SIMLIB_THREAD int   rng_count   = 0; /* Streams 0 .. rng_count - 1. */
+static SIMLIB_THREAD int   rng_backend = RNG_LCG;
+
+/* Transition matrices of the two recursions, and their 2^40th, 2^76th and
+   2^127th powers, which step one entity, one substream and one stream
+   ahead. */
+
+static unsigned long long mrg_a1[3][3] =
+    {{0, 1, 0}, {0, 0, 1}, {MRG_M1 - MRG_A13N, MRG_A12, 0}};
+static unsigned long long mrg_a2[3][3] =
+    {{0, 1, 0}, {0, 0, 1}, {MRG_M2 - MRG_A23N, 0, MRG_A21}};
+static unsigned long long mrg_a1p76[3][3] = {
+    {  82758667, 1871391091, 4127413238},
+    {3672831523,   69195019, 1871391091},
+    {3672091415, 3528743235,   69195019}};
+static unsigned long long mrg_a2p76[3][3] = {
+    {1511326704, 3759209742, 1610795712},
+    {4292754251, 1511326704, 3889917532},
+    {3859662829, 4292754251, 3708466080}};
+static unsigned long long mrg_a1p127[3][3] = {
+    {2427906178, 3580155704,  949770784},
+    { 226153695, 1230515664, 3580155704},
+    {1988835001,  986791581, 1230515664}};
+static unsigned long long mrg_a2p127[3][3] = {
+    {1464411153,  277697599, 1610723613},
+    {  32183930, 1464411153, 1022607788},
+    {2824425944,   32183930, 2093834863}};
+static unsigned long long mrg_a1p40[3][3] = {
+    {4171745404, 4064983592, 1934508265},
+    {3049723261, 1744636487, 4064983592},
+    { 947753516, 3952135907, 1744636487}};
+static unsigned long long mrg_a2p40[3][3] = {
+    {4158106802, 3062358456, 1815738463},
+    {1379176112, 4158106802, 3926509890},
+    {2842564878, 1379176112, 2852219546}};
+
+
+static void mrg_matmat(unsigned long long a[3][3], unsigned long long b[3][3],
+                       unsigned long long m, unsigned long long c[3][3])
+{
+    /* c = a * b (mod m); c may be a or b. */
+
+    unsigned long long t[3][3];
+    int i, j, k;
+
+    for (i = 0; i < 3; ++i)
+        for (j = 0; j < 3; ++j) {
+            t[i][j] = 0;
+            for (k = 0; k < 3; ++k)
+                t[i][j] = (t[i][j] + a[i][k] * b[k][j] % m) % m;
+        }
+    for (i = 0; i < 3; ++i)
+        for (j = 0; j < 3; ++j)
+            c[i][j] = t[i][j];
+}
+
+
+static void mrg_matpow(unsigned long long a[3][3], unsigned long long e,
+                       unsigned long long m, unsigned long long c[3][3])
+{
+    /* c = a^e (mod m), by square-and-multiply. */
+
+    unsigned long long square[3][3];
+    int i, j;
+
+    for (i = 0; i < 3; ++i)
+        for (j = 0; j < 3; ++j) {
+            square[i][j] = a[i][j];
+            c[i][j]      = (i == j);
+        }
+    for (; e > 0; e >>= 1) {
+        if (e & 1) mrg_matmat(c, square, m, c);
+        mrg_matmat(square, square, m, square);
+    }
+}
+
+
+static void mrg_matvec(unsigned long long a[3][3], long long *v,
+                       unsigned long long m)
+{
+    /* v = a * v (mod m). */
+
+    unsigned long long t[3];
+    int i, k;
+
+    for (i = 0; i < 3; ++i) {
+        t[i] = 0;
+        for (k = 0; k < 3; ++k)
+            t[i] = (t[i] + a[i][k] * (unsigned long long) v[k] % m) % m;
+    }
+    for (i = 0; i < 3; ++i)
+        v[i] = (long long) t[i];
+}
+
+
+static void mrg_start(int stream, int rep, unsigned long long entity)
+{
+    /* Set stream "stream" to the start of entity "entity" in substream
+       rep. */
+
+    unsigned long long p1[3][3], p2[3][3];
+    int i;
+
+    rng[stream].st.rep    = rep;
+    rng[stream].st.entity = entity;
+    rng[stream].st.draw   = 0;
+
+    for (i = 0; i < 6; ++i)
+        rng[stream].st.mrg[i] = 12345;
+    mrg_matpow(mrg_a1p127, stream, MRG_M1, p1);
+    mrg_matpow(mrg_a2p127, stream, MRG_M2, p2);
+    mrg_matvec(p1, &rng[stream].st.mrg[0], MRG_M1);
+    mrg_matvec(p2, &rng[stream].st.mrg[3], MRG_M2);
+    mrg_matpow(mrg_a1p76, rep, MRG_M1, p1);
+    mrg_matpow(mrg_a2p76, rep, MRG_M2, p2);
+    mrg_matvec(p1, &rng[stream].st.mrg[0], MRG_M1);
+    mrg_matvec(p2, &rng[stream].st.mrg[3], MRG_M2);
+    if (entity > 0) {
+        mrg_matpow(mrg_a1p40, entity, MRG_M1, p1);
+        mrg_matpow(mrg_a2p40, entity, MRG_M2, p2);
+        mrg_matvec(p1, &rng[stream].st.mrg[0], MRG_M1);
+        mrg_matvec(p2, &rng[stream].st.mrg[3], MRG_M2);
+    }
+}
+
+/* Counter-based generator Philox4x32-10 (Salmon et al., "Parallel Random
+   Numbers: As Easy as 1, 2, 3", SC11), selected by
+          lcgrand_backend(RNG_PHILOX);
+   Number "draw" of entity "entity" in stream "stream" of replication rep is a
+   pure function of those four values: the 128-bit counter is (draw / 4,
+   entity), the 64-bit key is derived from (rep, stream) by philox_key, and
+   the number is word draw % 4 of the encrypted counter.  Nothing is advanced
+   sequentially, so any thread can compute any number, and results do not
+   depend on the number of threads or the order in which they run.
+   lcgrand_substream(stream, rep) selects the replication and
+   lcgrand_entity(stream, entity) the entity (both restart at draw 0),
+   lcgrand_jump adds to the draw index, and lcgrandst and lcgrandgt set and
+   return the draw index.  Without the stream table,
+          u = philox_uniform(rep, stream, entity, draw);
+   returns the same number directly.  (The code assumes 32-bit unsigned
+   ints.) */
+
+#define PHILOX_M0  0xD2511F53U
+#define PHILOX_M1  0xCD9E8D57U
+#define PHILOX_W0  0x9E3779B9U      /* Key increments (golden ratio, */
+#define PHILOX_W1  0xBB67AE85U      /* sqrt(3) - 1). */
+#define PHILOX_ROUNDS  10
+#define PHILOX_NONE  (~0ULL)        /* No block cached. */
+
+static void philox_block(unsigned int ctr[4], unsigned int key[2],
+                         unsigned int out[4])
+{
+    /* Encrypt counter ctr under key "key" into out. */
+
+    unsigned long long p0, p1;
+    unsigned int c0, c1, c2, c3, k0, k1;
+    int r;
+
+    c0 = ctr[0]; c1 = ctr[1]; c2 = ctr[2]; c3 = ctr[3];
+    k0 = key[0]; k1 = key[1];
+    for (r = 0; r < PHILOX_ROUNDS; ++r) {
+        p0 = (unsigned long long) PHILOX_M0 * c0;
+        p1 = (unsigned long long) PHILOX_M1 * c2;
+        c0 = (unsigned int) (p1 >> 32) ^ c1 ^ k0;
+        c2 = (unsigned int) (p0 >> 32) ^ c3 ^ k1;
+        c1 = (unsigned int) p1;
+        c3 = (unsigned int) p0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+
+static void philox_key(int rep, int stream, unsigned int key[2])
+{
+    /* Derive the key of stream "stream" in replication rep by encrypting
+       (stream, rep, "SIML", 0) under the zero key, so that nearby pairs get
+       unrelated keys. */
+
+    unsigned int ctr[4], zero[2], out[4];
+
+    ctr[0]  = (unsigned int) stream;
+    ctr[1]  = (unsigned int) rep;
+    ctr[2]  = 0x53494D4CU;
+    ctr[3]  = 0;
+    zero[0] = zero[1] = 0;
+    philox_block(ctr, zero, out);
+    key[0] = out[0];
+    key[1] = out[1];
+}
+
+
+static unsigned int philox_word(unsigned int key[2], unsigned long long entity,
+                                unsigned long long draw, unsigned int out[4],
+                                unsigned long long *block)
+{
+    /* Return 32-bit word "draw" of entity "entity" under key "key", using
+       out as a cache of block *block. */
+
+    unsigned int ctr[4];
+
+    if (*block != draw >> 2) {
+        *block = draw >> 2;
+        ctr[0] = (unsigned int) *block;
+        ctr[1] = (unsigned int) (*block >> 32);
+        ctr[2] = (unsigned int) entity;
+        ctr[3] = (unsigned int) (entity >> 32);
+        philox_block(ctr, key, out);
+    }
+    return out[draw & 3];
+}
+
+
+static void philox_start(int stream, int rep, unsigned long long entity)
+{
+    /* Set stream "stream" to draw 0 of entity "entity" in replication rep. */
+
+    philox_key(rep, stream, rng[stream].st.key);
+    rng[stream].st.rep    = rep;
+    rng[stream].st.entity = entity;
+    rng[stream].st.draw   = 0;
+    rng[stream].st.block  = PHILOX_NONE;
+}
+
+
+static double philox_next(int stream)
+{
+    /* Return the next U(0,1) number of stream "stream", an odd multiple of
+       2^-33. */
+
+    struct rng_state *st;
+
+    st = &rng[stream].st;
+    return (philox_word(st->key, st->entity, st->draw++, st->out, &st->block)
+            + 0.5) * (1.0 / 4294967296.0);
+}
+
+
+double philox_uniform(int rep, int stream, long entity, long draw)
+{
+    /* Return number "draw" of entity "entity" in stream "stream" of
+       replication rep under the Philox backend, without touching any stream
+       state. */
+
+    unsigned int key[2], out[4];
+    unsigned long long block;
+
+    philox_key(rep, stream, key);
+    block = PHILOX_NONE;
+    return (philox_word(key, (unsigned long long) entity,
+                        (unsigned long long) draw, out, &block) + 0.5)
+           * (1.0 / 4294967296.0);
+}
+
+
+static void rng_default(int stream)
+{
+    /* Give stream "stream" its default seed under every backend. */
+
+    if (stream <= LCG_STREAMS)
+        rng[stream].st.z = zrng_default[stream];
+    else
+        rng[stream].st.z = lcg_multmod(lcg_power(100000L * (stream - 1)),
+                                       zrng_default[1]);
+    mrg_start(stream, 0, 0);
+    philox_start(stream, 0, 0);
+}
+
+
+static void rng_grow(int stream)
+{
+    /* Extend the stream table to include stream "stream", giving every new
+       stream its default seed under every backend. */
+
+    union rng_slot *table;
+    char *block;
+    int  count, s;
+
+    if (stream < 0) {
+        printf("\nInvalid random-number stream %d\n", stream);
+        exit(1);
+    }
+
+    count = (rng_count > 0) ? rng_count : LCG_STREAMS + 1;
+    while (count <= stream) count *= 2;
+
+    block = (char *) malloc(count * sizeof(union rng_slot) + RNG_LINE_SIZE - 1);
+    if (block == NULL) {
+        printf("\nOut of memory for random-number stream %d\n", stream);
+        exit(1);
+    }
+    table = (union rng_slot *) (((size_t) block + RNG_LINE_SIZE - 1)
+                                & ~(size_t) (RNG_LINE_SIZE - 1));
+    for (s = 0; s < rng_count; ++s)
+        table[s] = rng[s];
+    free(rng_block);
+    rng       = table;
+    rng_block = block;
+
+    for (s = rng_count; s < count; ++s) {
+        rng[s].st.buffer     = NULL;
+        rng[s].st.sobol      = NULL;
+        rng[s].st.antithetic = 0;
+        rng_default(s);
+    }
+    rng_count = count;
+}
+
+
+static double mrg_next(int stream)
+{
+    /* Advance stream "stream" by one step and return a U(0,1) number. */
+
+    long long *s, p1, p2;
+
+    s = rng[stream].st.mrg;
+
+    p1 = (MRG_A12 * s[1] - MRG_A13N * s[0]) % MRG_M1;
+    if (p1 < 0) p1 += MRG_M1;
+    s[0] = s[1]; s[1] = s[2]; s[2] = p1;
+
+    p2 = (MRG_A21 * s[5] - MRG_A23N * s[3]) % MRG_M2;
+    if (p2 < 0) p2 += MRG_M2;
+    s[3] = s[4]; s[4] = s[5]; s[5] = p2;
+
+    ++rng[stream].st.draw;
+    return ((p1 > p2) ? (p1 - p2) : (p1 - p2 + MRG_M1)) * MRG_NORM;
+}
+
+
+static void rng_advance(int stream, unsigned long long k)
+{
+    /* Jump the generator of stream "stream" ahead by k numbers, ignoring any
+       buffer. */
+
+    unsigned long long p1[3][3], p2[3][3];
+
+    if (rng_backend == RNG_PHILOX)
+        rng[stream].st.draw += k;
+    else if (rng_backend == RNG_MRG32K3A) {
+        rng[stream].st.draw += k;
+        mrg_matpow(mrg_a1, k, MRG_M1, p1);
+        mrg_matpow(mrg_a2, k, MRG_M2, p2);
+        mrg_matvec(p1, &rng[stream].st.mrg[0], MRG_M1);
+        mrg_matvec(p2, &rng[stream].st.mrg[3], MRG_M2);
+    }
+    else
+        rng[stream].st.z = lcg_multmod(lcg_power(k % (MODLUS - 1)),
+                                       rng[stream].st.z);
+}
+
+
+static void rng_sync(int stream)
+{
+    /* Rewind the generator of a buffered stream to the last number handed out
+       and empty the buffer. */
+
+    struct rng_buffer *buffer;
+    struct rng_sobol  *sobol;
+    int    antithetic;
+
+    buffer = rng[stream].st.buffer;
+    if (buffer == NULL || buffer->next == buffer->count) {
+        if (buffer != NULL) buffer->next = buffer->count = 0;
+        return;
+    }
+
+    /* Restore the generator, but keep the settings of the stream. */
+
+    sobol      = rng[stream].st.sobol;
+    antithetic = rng[stream].st.antithetic;
+    rng[stream].st            = buffer->start;
+    rng[stream].st.sobol      = sobol;
+    rng[stream].st.antithetic = antithetic;
+    rng_advance(stream, buffer->next);
+    buffer->next = buffer->count = 0;
+}
+
+
+static void lcg_fill(int stream, unsigned long long z[], int n)
+{
+    /* Put the next n states Z[i] of LCG stream "stream" in z[0..n-1] and leave
+       the stream at the last of them.  Lane j produces states j,
+       j + LCG_LANES, j + 2 * LCG_LANES, ... each lane stepping LCG_LANES states
+       at a time with multiplier MULT^LCG_LANES.  The lanes are independent,
+       so the inner loop can be vectorized or pipelined, and the states are the
+       same as sequential calls would produce. */
+
+    unsigned long long lane[LCG_LANES], step, product;
+    long  state;
+    int   i, j;
+
+    state = rng[stream].st.z;
+    for (j = 0; j < LCG_LANES; ++j) {
+        state   = lcg_multmod(MULT, state);
+        lane[j] = state;
+    }
+    step = lcg_power(LCG_LANES);
+
+    for (i = 0; i + LCG_LANES <= n; i += LCG_LANES)
+        for (j = 0; j < LCG_LANES; ++j) {
+            z[i + j] = lane[j];
+            product  = lane[j] * step;
+            product  = (product & MODLUS) + (product >> 31);
+            lane[j]  = (product >= MODLUS) ? product - MODLUS : product;
+        }
+    for (j = 0; i + j < n; ++j)
+        z[i + j] = lane[j];
+
+    if (n > 0) rng[stream].st.z = (long) z[n - 1];
+}
+
+
+static void rng_fill(int stream, double u[], int n)
+{
+    /* Fill u[0..n-1] from the generator of stream "stream", ignoring any
+       buffer, at the full resolution of the generator (see rng_next). */
+
+    unsigned long long z[LCG_FILL_CHUNK];
+    int   i, j, k;
+
+    if (rng_backend == RNG_MRG32K3A) {
+        for (i = 0; i < n; ++i)
+            u[i] = mrg_next(stream);
+        return;
+    }
+    if (rng_backend == RNG_PHILOX) {
+        for (i = 0; i < n; ++i)
+            u[i] = philox_next(stream);
+        return;
+    }
+
+    for (i = 0; i < n; i += k) {
+        k = (n - i < LCG_FILL_CHUNK) ? n - i : LCG_FILL_CHUNK;
+        lcg_fill(stream, z, k);
+        for (j = 0; j < k; ++j)
+            u[i + j] = z[j] * (1.0 / 2147483648.0);
+    }
+}
+
+
+void lcgrand_backend(int backend) /* Select the generator behind lcgrand. */
+{
+    int stream;
+
+    if (!(backend == RNG_LCG || backend == RNG_MRG32K3A ||
+          backend == RNG_PHILOX)) {
+        printf("\n%d is an invalid random-number backend\n", backend);
+        exit(1);
+    }
+
+    for (stream = 0; stream < rng_count; ++stream)
+        rng_sync(stream);
+
+    rng_backend = backend;
+    if (backend == RNG_MRG32K3A)
+        for (stream = 0; stream < rng_count; ++stream)
+            mrg_start(stream, 0, 0);
+    if (backend == RNG_PHILOX)
+        for (stream = 0; stream < rng_count; ++stream)
+            philox_start(stream, 0, 0);
+}
+
+/* Scrambled Sobol sequence behind a stream (lcgrand_sobol).  Dimension 1 is
+   the van der Corput sequence and dimensions 2 through SOBOL_MAX_DIMS use
+   the primitive polynomials and initial direction numbers of Joe and Kuo
+   ("Constructing Sobol Sequences with Better Two-Dimensional Projections",
+   SIAM J. Sci. Comput. 30, 2008).  Each dimension is randomized by a random
+   linear matrix scramble followed by a random digital shift (Matousek,
+   "On the L2-Discrepancy for Anchored Boxes", J. Complexity 14, 1998), so
+   every point is U(0,1)^dims and independent randomizations give valid
+   confidence intervals.  Points follow in Gray-code order. */
+
+static int sobol_degree[SOBOL_MAX_DIMS] = {0, 1, 2, 3, 3, 4, 4, 5, 5, 5};
+static int sobol_poly[SOBOL_MAX_DIMS]   = {0, 0, 1, 1, 2, 1, 4, 2, 4, 7};
+static int sobol_init[SOBOL_MAX_DIMS][5] = {
+    {0}, {1}, {1, 3}, {1, 3, 1}, {1, 1, 1}, {1, 1, 3, 3}, {1, 3, 5, 13},
+    {1, 1, 5, 5, 17}, {1, 1, 5, 5, 5}, {1, 1, 7, 11, 19}};
+
+struct rng_sobol {
+    int    dims;                        /* Numbers per point. */
+    int    next;                        /* Dimension of the next number. */
+    unsigned long long index;           /* Index of the current point. */
+    unsigned int v[SOBOL_MAX_DIMS][32]; /* Scrambled direction numbers. */
+    unsigned int x[SOBOL_MAX_DIMS];     /* Current point, scrambled. */
+    unsigned int shift[SOBOL_MAX_DIMS]; /* Digital shift, the first point. */
+};
+
+struct sobol_cursor {                   /* Position in a Sobol sequence. */
+    int    next;
+    unsigned long long index;
+    unsigned int x[SOBOL_MAX_DIMS];
+};
+
+
+static void sobol_rewind(struct rng_sobol *sobol)
+{
+    /* Go back to the first point of the Sobol sequence "sobol". */
+
+    int d;
+
+    sobol->next  = 0;
+    sobol->index = 0;
+    for (d = 0; d < sobol->dims; ++d)
+        sobol->x[d] = sobol->shift[d];
+}
+
+
+static double sobol_next(struct rng_sobol *sobol)
+{
+    /* Return the next coordinate of the scrambled Sobol sequence "sobol",
+       moving to the next point after coordinate dims. */
+
+    unsigned long long i;
+    int c, d;
+
+    if (sobol->next == sobol->dims) {
+        i = ++sobol->index;
+        for (c = 0; (i & 1) == 0; i >>= 1) ++c;
+        if (c >= 32) {
+            printf("\nSobol sequence exhausted after 2^32 points\n");
+            exit(1);
+        }
+        for (d = 0; d < sobol->dims; ++d)
+            sobol->x[d] ^= sobol->v[d][c];
+        sobol->next = 0;
+    }
+    return (sobol->x[sobol->next++] + 0.5) * (1.0 / 4294967296.0);
+}
+
+
+/* Reduce a number from rng_next to the 24-bit resolution of lcgrand (an odd
+   multiple of 2^-25, as the original generator returned). */
+
+#define RNG_FLOAT(r)  ((float) (((long) ((r) * 16777216.0) | 1) / 16777216.0))
+
+static double rng_next(int stream)
+{
+    /* Return the next number of stream "stream" at the full resolution of the
+       generator: Z[i] / 2^31 for the LCG, the MRG32k3a or Philox output, or
+       the next Sobol coordinate. */
+
+    struct rng_buffer *buffer;
+    long   zi, lowprd, hi31;
+
+    if (rng[stream].st.sobol != NULL)
+        return sobol_next(rng[stream].st.sobol);
+
+    buffer = rng[stream].st.buffer;
+    if (buffer != NULL) {
+        if (buffer->next == buffer->count) {  /* Refill. */
+            buffer->start = rng[stream].st;
+            rng_fill(stream, buffer->u, buffer->size);
+            buffer->count = buffer->size;
+            buffer->next  = 0;
+        }
+        return buffer->u[buffer->next++];
+    }
+
+    if (rng_backend == RNG_MRG32K3A)
+        return mrg_next(stream);
+    if (rng_backend == RNG_PHILOX)
+        return philox_next(stream);
+
+    zi     = rng[stream].st.z;
+    lowprd = (zi & 65535) * MULT1;
+    hi31   = (zi >> 16) * MULT1 + (lowprd >> 16);
+    zi     = ((lowprd & 65535) - MODLUS) +
+             ((hi31 & 32767) << 16) + (hi31 >> 15);
+    if (zi < 0) zi += MODLUS;
+    lowprd = (zi & 65535) * MULT2;
+    hi31   = (zi >> 16) * MULT2 + (lowprd >> 16);
+    zi     = ((lowprd & 65535) - MODLUS) +
+             ((hi31 & 32767) << 16) + (hi31 >> 15);
+    if (zi < 0) zi += MODLUS;
+    rng[stream].st.z = zi;
+    return zi / 2147483648.0;
+}
+
+
+static unsigned int rng_bits(int stream)
+{
+    /* Return 32 random bits from the generator of stream "stream", 16 from
+       each of two numbers. */
+
+    unsigned int high;
+
+    high = (unsigned int) (rng_next(stream) * 65536.0);
+    return (high << 16) | (unsigned int) (rng_next(stream) * 65536.0);
+}
+
+
+/* Ziggurat method of Marsaglia and Tsang ("The Ziggurat Method for
+   Generating Random Variables", J. Statistical Software 5, 2000), 256 layers
+   for the exponential and 128 for the normal.  A 32-bit word from the
+   stream picks a layer with bits 1-8 (bit 0 of an LCG word is always 0) and
+   a point in it with all 32 bits; about 99% of the time the point is inside
+   the layer's rectangle and is returned with no transcendental function.
+   Each thread has its own tables, built when it first selects
+   VARIATE_ZIGGURAT (with variate_method or simlib_ctx_use).  Its variates
+   are not monotone in the numbers of the stream, so antithetic and Sobol
+   streams, and both runs of simlib_antithetic, use the inverse transform
+   instead. */
+
+#define ZIG_ER  7.69711747013104972     /* Start of the exponential tail. */
+#define ZIG_EV  3.949659822581572e-3    /* Area of each exponential layer. */
+#define ZIG_NR  3.442619855899          /* Start of the normal tail. */
+#define ZIG_NV  9.91256303526217e-3     /* Area of each normal layer. */
+
+static SIMLIB_THREAD unsigned int zig_ke[256], zig_kn[128];
+static SIMLIB_THREAD double       zig_we[256], zig_fe[256], zig_wn[128],
+                                  zig_fn[128];
+static SIMLIB_THREAD int          zig_ready = 0;
+
+
+static void ziggurat_tables(void)
+{
+    /* Build the layer tables: k is the rectangle test threshold for a word,
+       w converts a word into an abscissa, f is the density at the layer
+       boundary. */
+
+    double de, te, dn, tn, q;
+    int    i;
+
+    de = te = ZIG_ER;
+    q  = ZIG_EV / exp(-de);
+    zig_ke[0]   = (unsigned int) ((de / q) * 4294967296.0);
+    zig_ke[1]   = 0;
+    zig_we[0]   = q / 4294967296.0;
+    zig_we[255] = de / 4294967296.0;
+    zig_fe[0]   = 1.0;
+    zig_fe[255] = exp(-de);
+    for (i = 254; i >= 1; --i) {
+        de = -log(ZIG_EV / de + exp(-de));
+        zig_ke[i + 1] = (unsigned int) ((de / te) * 4294967296.0);
+        te = de;
+        zig_fe[i] = exp(-de);
+        zig_we[i] = de / 4294967296.0;
+    }
+
+    dn = tn = ZIG_NR;
+    q  = ZIG_NV / exp(-0.5 * dn * dn);
+    zig_kn[0]   = (unsigned int) ((dn / q) * 2147483648.0);
+    zig_kn[1]   = 0;
+    zig_wn[0]   = q / 2147483648.0;
+    zig_wn[127] = dn / 2147483648.0;
+    zig_fn[0]   = 1.0;
+    zig_fn[127] = exp(-0.5 * dn * dn);
+    for (i = 126; i >= 1; --i) {
+        dn = sqrt(-2.0 * log(ZIG_NV / dn + exp(-0.5 * dn * dn)));
+        zig_kn[i + 1] = (unsigned int) ((dn / tn) * 2147483648.0);
+        tn = dn;
+        zig_fn[i] = exp(-0.5 * dn * dn);
+        zig_wn[i] = dn / 2147483648.0;
+    }
+    zig_ready = 1;
+}
+
+
+static int ziggurat_stream(int stream)
+{
+    /* Return nonzero if stream "stream" can feed the ziggurat.  Antithetic
+       and Sobol streams cannot (the ziggurat is not monotone in its
+       numbers), so they keep the inverse transform; for the same reason
+       simlib_antithetic runs both halves of a pair with inversion. */
+
+    if (stream < 0 || stream >= rng_count) rng_grow(stream);
+    return !rng[stream].st.antithetic && rng[stream].st.sobol == NULL;
+}
+
+
+static double ziggurat_expon(int stream)
+{
+    /* Return an exponential variate with mean 1. */
+
+    unsigned int w;
+    double x;
+    int    i;
+
+    for (;;) {
+        w = (unsigned int) (rng_next(stream) * 4294967296.0);
+        i = (w >> 1) & 255;
+        if (w < zig_ke[i])                       /* Inside the rectangle. */
+            return w * zig_we[i];
+        if (i == 0)                              /* Tail. */
+            return ZIG_ER - log(rng_next(stream));
+        x = w * zig_we[i];                       /* Wedge. */
+        if (zig_fe[i] + rng_next(stream) * (zig_fe[i - 1] - zig_fe[i])
+            < exp(-x))
+            return x;
+    }
+}
+
+
+static double ziggurat_normal(int stream)
+{
+    /* Return a standard normal variate.  The word is read as a signed
+       number, whose sign is the sign of the variate. */
+
+    unsigned int w;
+    double h, x, y;
+    int    i;
+
+    for (;;) {
+        w = (unsigned int) (rng_next(stream) * 4294967296.0);
+        h = (w & 0x80000000U) ? (double) w - 4294967296.0 : (double) w;
+        i = (w >> 1) & 127;
+        if (fabs(h) < zig_kn[i])                 /* Inside the rectangle. */
+            return h * zig_wn[i];
+        if (i == 0) {                            /* Tail. */
+            do {
+                x = -log(rng_next(stream)) / ZIG_NR;
+                y = -log(rng_next(stream));
+            } while (y + y < x * x);
+            return (h > 0) ? ZIG_NR + x : -ZIG_NR - x;
+        }
+        x = h * zig_wn[i];                       /* Wedge. */
+        if (zig_fn[i] + rng_next(stream) * (zig_fn[i - 1] - zig_fn[i])
+            < exp(-0.5 * x * x))
+            return x;
+    }
+}
+
+
+void variate_method(int method) /* Select the method behind expon, expon_d,
+                                   normal and normal_d. */
+{
+    if (!(method == VARIATE_INVERSION || method == VARIATE_ZIGGURAT)) {
+        printf("\n%d is an invalid variate method\n", method);
+        exit(1);
+    }
+
+    if (method == VARIATE_ZIGGURAT && !zig_ready)
+        ziggurat_tables();
+    variates = method;
+}
+
+
+/* Generate the next random number. */
+
+float lcgrand(int stream)
+{
+    if (stream < 0 || stream >= rng_count) rng_grow(stream);
+    if (rng[stream].st.antithetic)
+        return 1.0f - RNG_FLOAT(rng_next(stream));
+    return RNG_FLOAT(rng_next(stream));
+}
+
+
+static double rng_uniform(int stream)
+{
+    /* Return the next number of stream "stream" at the full resolution of
+       the generator (one step of it, unlike lcgrand_d), as 1 - u if the
+       stream is antithetic. */
+
+    double u;
+
+    if (stream < 0 || stream >= rng_count) rng_grow(stream);
+    u = rng_next(stream);
+    return rng[stream].st.antithetic ? 1.0 - u : u;
+}
+
+
+double lcgrand_d(int stream) /* Generate the next random number with 53-bit
+                                resolution. */
+{
+    double high, low, u;
+
+    if (stream < 0 || stream >= rng_count) rng_grow(stream);
+
+    /* Take 26 bits from each of two successive numbers, giving an odd
+       multiple of 2^-53 (a Sobol stream gives one coordinate as it is). */
+
+    if (rng[stream].st.sobol != NULL)   /* One coordinate, 32 bits. */
+        u = sobol_next(rng[stream].st.sobol);
+    else {
+        high = floor(rng_next(stream) * 67108864.0);
+        low  = floor(rng_next(stream) * 67108864.0);
+        u    = (high * 67108864.0 + low + 0.5) / 4503599627370496.0;
+    }
+    return rng[stream].st.antithetic ? 1.0 - u : u;
+}
+
+
+void lcgrandst (long zset, int stream) /* Set the current zrng for stream
+                                          "stream" to zset. */
+{
+    if (stream < 0 || stream >= rng_count) rng_grow(stream);
+    rng_sync(stream);
+
+    if (rng_backend != RNG_LCG && zset < 0) {
+        printf("\nNo position %ld in stream %d\n", zset, stream);
+        exit(1);
+    }
+
+    if (rng_backend == RNG_PHILOX)
+        rng[stream].st.draw = (unsigned long long) zset;
+    else if (rng_backend == RNG_MRG32K3A) {
+        mrg_start(stream, rng[stream].st.rep, rng[stream].st.entity);
+        rng_advance(stream, (unsigned long long) zset);
+    }
+    else
+        rng[stream].st.z = zset;
+}
+
+
+long lcgrandgt (int stream) /* Return the current zrng for stream "stream". */
+{
+    if (stream < 0 || stream >= rng_count) rng_grow(stream);
+    rng_sync(stream);
+
+    if (rng_backend != RNG_LCG)
+        return (long) rng[stream].st.draw;
+    return rng[stream].st.z;
+}
+
+
+void lcgrand_jump(int stream, long k) /* Advance stream "stream" by k
+                                         numbers. */
+{
+    if (k < 0) {
+        printf("\nCannot jump stream %d back by %ld numbers\n", stream, -k);
+        exit(1);
+    }
+
+    if (stream < 0 || stream >= rng_count) rng_grow(stream);
+    rng_sync(stream);
+    rng_advance(stream, k);
+}
+
+
+void lcgrand_substream(int stream, int rep) /* Set stream "stream" to the
+                                               start of its block for
+                                               replication rep. */
+{
+    long block;
+
+    if (rng_backend != RNG_LCG) {
+        if (rep < 0) {
+            printf("\nNo substream %d for stream %d\n", rep, stream);
+            exit(1);
+        }
+        if (stream < 0 || stream >= rng_count) rng_grow(stream);
+        rng_sync(stream);
+        if (rng_backend == RNG_PHILOX)
+            philox_start(stream, rep, 0);
+        else
+            mrg_start(stream, rep, 0);
+        return;
+    }
+
+    block = (long) rep * LCG_STREAMS + (stream - 1);
+    if (stream < 1 || stream > LCG_STREAMS || rep < 0 ||
+        block >= (MODLUS - 1) / LCG_SUBSTREAM_LENGTH) {
+        printf("\nNo disjoint substream %d for stream %d\n", rep, stream);
+        exit(1);
+    }
+    if (stream < 0 || stream >= rng_count) rng_grow(stream);
+    rng_sync(stream);
+    rng[stream].st.z = lcg_multmod(lcg_power(block * LCG_SUBSTREAM_LENGTH),
+                               1973272912);   /* Default seed of stream 1. */
+}
+
+
+void lcgrand_fill(int stream, float u[], int n) /* Fill u[0..n-1] from stream
+                                                   "stream". */
+{
+    unsigned long long z[LCG_FILL_CHUNK];
+    int    i, j, k;
+
+    if (stream < 0 || stream >= rng_count) rng_grow(stream);
+    rng_sync(stream);
+
+    if (rng[stream].st.sobol != NULL)
+        for (i = 0; i < n; ++i)
+            u[i] = RNG_FLOAT(sobol_next(rng[stream].st.sobol));
+    else if (rng_backend != RNG_LCG) {
+        for (i = 0; i < n; ++i)
+            u[i] = RNG_FLOAT(rng_backend == RNG_PHILOX ? philox_next(stream)
+                                                       : mrg_next(stream));
+    }
+    else
+        for (i = 0; i < n; i += k) {
+            k = (n - i < LCG_FILL_CHUNK) ? n - i : LCG_FILL_CHUNK;
+            lcg_fill(stream, z, k);
+            for (j = 0; j < k; ++j)
+                u[i + j] = (float) ((z[j] >> 7) | 1) * (1.0f / 16777216.0f);
+        }
+
+    if (rng[stream].st.antithetic)
+        for (i = 0; i < n; ++i)
+            u[i] = 1.0f - u[i];
+}
+
+
+void lcgrand_buffer(int stream, int size) /* Buffer "size" numbers of stream
+                                             "stream" (0 = unbuffered). */
+{
+    struct rng_buffer *buffer;
+
+    if (stream < 0 || stream >= rng_count) rng_grow(stream);
+    rng_sync(stream);
+
+    buffer = rng[stream].st.buffer;
+    if (buffer != NULL) {
+        free((char *)buffer->u);
+        free((char *)buffer);
+        rng[stream].st.buffer = NULL;
+    }
+    if (size <= 0) return;
+
+    buffer = (struct rng_buffer *) malloc(sizeof(struct rng_buffer));
+    if (buffer != NULL)
+        buffer->u = (double *) malloc(size * sizeof(double));
+    if (buffer == NULL || buffer->u == NULL) {
+        printf("\nOut of memory for the buffer of stream %d\n", stream);
+        exit(1);
+    }
+    buffer->size  = size;
+    buffer->count = 0;
+    buffer->next  = 0;
+    rng[stream].st.buffer = buffer;
+}
+
+
+void lcgrand_entity(int stream, long entity) /* Set stream "stream" to the
+                                                start of the numbers of entity
+                                                "entity" in its current
+                                                replication. */
+{
+    if (rng_backend == RNG_LCG || entity < 0 ||
+        (rng_backend == RNG_MRG32K3A && entity >= MRG_ENTITIES)) {
+        printf("\nNo substream for entity %ld of stream %d\n", entity, stream);
+        exit(1);
+    }
+
+    if (stream < 0 || stream >= rng_count) rng_grow(stream);
+    rng_sync(stream);
+    if (rng_backend == RNG_PHILOX)
+        philox_start(stream, rng[stream].st.rep, (unsigned long long) entity);
+    else
+        mrg_start(stream, rng[stream].st.rep, (unsigned long long) entity);
+}
+
+
+void lcgrand_crn(int rep) /* Reset every stream to the start of replication
+                             rep, for common random numbers. */
+{
+    int stream;
+
+    /* The stream table only grows past LCG_STREAMS when a stream beyond it
+       has been used, and such streams have no disjoint LCG substreams. */
+
+    if (rng_backend == RNG_LCG && rng_count > LCG_STREAMS + 1) {
+        printf("\nNo disjoint substream %d for streams above %d\n", rep,
+               LCG_STREAMS);
+        exit(1);
+    }
+
+    /* Create streams 1 through LCG_STREAMS first, so that streams not used
+       yet start in replication rep too. */
+
+    if (rng_count <= LCG_STREAMS) rng_grow(LCG_STREAMS);
+    for (stream = 1; stream < rng_count; ++stream) {
+        lcgrand_substream(stream, rep);
+        if (rng[stream].st.sobol != NULL)
+            sobol_rewind(rng[stream].st.sobol);
+    }
+}
+
+
+void lcgrand_sobol(int stream, int dims) /* Serve stream "stream" from a
+                                            scrambled Sobol sequence of dims
+                                            dimensions (0 = off). */
+{
+    struct rng_sobol *sobol;
+    unsigned int mask, parity, scrambled[32];
+    int d, k, l, b, deg;
+
+    if (dims < 0 || dims > SOBOL_MAX_DIMS) {
+        printf("\n%d is an invalid number of Sobol dimensions\n", dims);
+        exit(1);
+    }
+
+    if (stream < 0 || stream >= rng_count) rng_grow(stream);
+    if (rng[stream].st.sobol != NULL) {
+        free((char *)rng[stream].st.sobol);
+        rng[stream].st.sobol = NULL;
+    }
+    if (dims == 0) return;
+
+    sobol = (struct rng_sobol *) malloc(sizeof(struct rng_sobol));
+    if (sobol == NULL) {
+        printf("\nOut of memory for the Sobol sequence of stream %d\n",
+               stream);
+        exit(1);
+    }
+    sobol->dims  = dims;
+    sobol->next  = 0;
+    sobol->index = 0;
+
+    for (d = 0; d < dims; ++d) {
+
+        /* Direction numbers v[k] = m[k] / 2^(k+1), as 32-bit fractions. */
+
+        deg = sobol_degree[d];
+        for (k = 0; k < 32; ++k) {
+            if (d == 0)
+                sobol->v[d][k] = 1U << (31 - k);
+            else if (k < deg)
+                sobol->v[d][k] = (unsigned int) sobol_init[d][k] << (31 - k);
+            else {
+                sobol->v[d][k] = sobol->v[d][k - deg]
+                                 ^ (sobol->v[d][k - deg] >> deg);
+                for (l = 1; l < deg; ++l)
+                    if ((sobol_poly[d] >> (deg - 1 - l)) & 1)
+                        sobol->v[d][k] ^= sobol->v[d][k - l];
+            }
+        }
+
+        /* Linear matrix scramble: output bit b is the parity of the input
+           bits masked by a row with bit b set and random higher bits. */
+
+        for (k = 0; k < 32; ++k)
+            scrambled[k] = 0;
+        for (b = 0; b < 32; ++b) {
+            mask = (1U << b) | (b < 31 ? rng_bits(stream) & (~0U << (b + 1))
+                                       : 0);
+            for (k = 0; k < 32; ++k) {
+                parity = sobol->v[d][k] & mask;
+                parity ^= parity >> 16;
+                parity ^= parity >> 8;
+                parity ^= parity >> 4;
+                parity ^= parity >> 2;
+                parity ^= parity >> 1;
+                scrambled[k] |= (parity & 1) << b;
+            }
+        }
+        for (k = 0; k < 32; ++k)
+            sobol->v[d][k] = scrambled[k];
+
+        /* Digital shift, which is also the first point. */
+
+        sobol->shift[d] = rng_bits(stream);
+        sobol->x[d]     = sobol->shift[d];
+    }
+
+    rng[stream].st.sobol = sobol;
+}
+
+
+void lcgrand_set_antithetic(int stream, int on) /* Have stream "stream"
+                                                   return 1 - u (on nonzero)
+                                                   or u (on zero). */
+{
+    if (stream < 0 || stream >= rng_count) rng_grow(stream);
+    rng[stream].st.antithetic = (on != 0);
+}
+
+
+void simlib_antithetic(void (*model)(double est[]), int n, double est[])
+{
+    /* Run "model" twice from the same stream states, first with every stream
+       plain and then with every stream antithetic, and return in
+       est[0..n-1] the averages of the n estimates the two runs put in their
+       est arguments.  Both runs use the inverse transform, since a
+       ziggurat variate from u is unrelated to one from 1 - u.  Streams are
+       left as the second run leaves them, all plain. */
+
+    struct rng_state    *saved;
+    struct sobol_cursor *cursor;
+    struct rng_sobol    *sobol;
+    struct rng_buffer   *buffer;
+    double *first;
+    int    count, s, i, method;
+
+    method   = variates;
+    variates = VARIATE_INVERSION;
+    for (s = 0; s < rng_count; ++s) {
+        rng_sync(s);
+        rng[s].st.antithetic = 0;
+    }
+    count = rng_count;
+    saved  = (struct rng_state *) malloc(count * sizeof(struct rng_state));
+    cursor = (struct sobol_cursor *) malloc(count
+                                            * sizeof(struct sobol_cursor));
+    first  = (double *) malloc((n > 0 ? n : 1) * sizeof(double));
+    if (saved == NULL || cursor == NULL || first == NULL) {
+        printf("\nOut of memory for an antithetic pair\n");
+        exit(1);
+    }
+    for (s = 0; s < count; ++s) {
+        saved[s] = rng[s].st;
+        if ((sobol = rng[s].st.sobol) != NULL) {
+            cursor[s].next  = sobol->next;
+            cursor[s].index = sobol->index;
+            for (i = 0; i < sobol->dims; ++i)
+                cursor[s].x[i] = sobol->x[i];
+        }
+    }
+
+    (*model)(first);
+
+    /* Rewind every stream, including any created by the first run and the
+       position of each Sobol sequence, and rerun with antithetic numbers.  The
+       current buffer and Sobol sequence of each stream are kept, since the
+       first run may have replaced or freed the saved ones (with
+       lcgrand_buffer or lcgrand_sobol), and the rerun replaces them again;
+       rng_sync leaves the buffer empty. */
+
+    for (s = 0; s < rng_count; ++s) {
+        rng_sync(s);
+        buffer = rng[s].st.buffer;
+        sobol  = rng[s].st.sobol;
+        if (s < count) {
+            rng[s].st = saved[s];
+            if (sobol != NULL && sobol == saved[s].sobol) {
+                sobol->next  = cursor[s].next;
+                sobol->index = cursor[s].index;
+                for (i = 0; i < sobol->dims; ++i)
+                    sobol->x[i] = cursor[s].x[i];
+            }
+        }
+        else
+            rng_default(s);
+        rng[s].st.buffer     = buffer;
+        rng[s].st.sobol      = sobol;
+        rng[s].st.antithetic = 1;
+    }
+
+    (*model)(est);
+
+    for (s = 0; s < rng_count; ++s)
+        rng[s].st.antithetic = 0;
+    for (i = 0; i < n; ++i)
+        est[i] = 0.5 * (first[i] + est[i]);
+    variates = method;
+
+    free((char *)saved);
+    free((char *)cursor);
+    free((char *)first);
+}
+
+
+/* Simulation contexts.  A context holds everything a simulation changes: the
+   lists, clock and transfer array, the statistics, the random-number streams
+   and the variate method.  Each thread runs the simulation of the context it
+   is using, through the usual simlib functions and global variables, so
+   several threads can simulate at once:
+          ctx = simlib_ctx_create();
+          previous = simlib_ctx_use(ctx);
+          init_simlib();
+          ...                               (run and report the simulation)
+          simlib_ctx_use(previous);
+          simlib_ctx_free(ctx);
+   Until a thread selects a context it uses its own default one, so programs
+   that never call simlib_ctx_use run as before.  simlib_ctx_use(NULL)
+   returns the thread to its default context.  A context is used by one
+   thread at a time, but may move between threads. */
+
+struct simlib_ctx {
+    int    *list_rank, *list_size, next_event_type, maxatr, maxlist;
+    float  *transfer, sim_time, prob_distrib[26];
+    struct master **head, **tail;
+    struct statistic *sampst_stat, *timest_stat, *residence;
+    float  *preval, *tlvc;
+    int    *list_stats, *list_sampst;
+    struct series **series;
+    int    variates;
+    union rng_slot *rng;
+    char   *rng_block;
+    int    rng_count, rng_backend;
+};
+
+static SIMLIB_THREAD struct simlib_ctx ctx_default;     /* Thread default. */
+static SIMLIB_THREAD struct simlib_ctx *ctx_current = NULL; /* NULL: default. */
+
+
+static void ctx_save(struct simlib_ctx *ctx)
+{
+    /* Store the state of the running simulation in "ctx". */
+
+    int i;
+
+    ctx->list_rank       = list_rank;
+    ctx->list_size       = list_size;
+    ctx->next_event_type = next_event_type;
+    ctx->maxatr          = maxatr;
+    ctx->maxlist         = maxlist;
+    ctx->transfer        = transfer;
+    ctx->sim_time        = sim_time;
+    for (i = 0; i < 26; ++i)
+        ctx->prob_distrib[i] = prob_distrib[i];
+    ctx->head            = head;
+    ctx->tail            = tail;
+    ctx->sampst_stat     = sampst_stat;
+    ctx->timest_stat     = timest_stat;
+    ctx->residence       = residence;
+    ctx->preval          = preval;
+    ctx->tlvc            = tlvc;
+    ctx->list_stats      = list_stats;
+    ctx->list_sampst     = list_sampst;
+    ctx->series          = series;
+    ctx->variates        = variates;
+    ctx->rng             = rng;
+    ctx->rng_block       = rng_block;
+    ctx->rng_count       = rng_count;
+    ctx->rng_backend     = rng_backend;
+}
+
+
+static void ctx_load(struct simlib_ctx *ctx)
+{
+    /* Make the simulation in "ctx" the running one. */
+
+    int i;
+
+    list_rank       = ctx->list_rank;
+    list_size       = ctx->list_size;
+    next_event_type = ctx->next_event_type;
+    maxatr          = ctx->maxatr;
+    maxlist         = ctx->maxlist;
+    transfer        = ctx->transfer;
+    sim_time        = ctx->sim_time;
+    for (i = 0; i < 26; ++i)
+        prob_distrib[i] = ctx->prob_distrib[i];
+    head            = ctx->head;
+    tail            = ctx->tail;
+    sampst_stat     = ctx->sampst_stat;
+    timest_stat     = ctx->timest_stat;
+    residence       = ctx->residence;
+    preval          = ctx->preval;
+    tlvc            = ctx->tlvc;
+    list_stats      = ctx->list_stats;
+    list_sampst     = ctx->list_sampst;
+    series          = ctx->series;
+    variates        = ctx->variates;
+    rng             = ctx->rng;
+    rng_block       = ctx->rng_block;
+    rng_count       = ctx->rng_count;
+    rng_backend     = ctx->rng_backend;
+
+    if (variates == VARIATE_ZIGGURAT && !zig_ready)
+        ziggurat_tables();
+}
+
+
+struct simlib_ctx *simlib_ctx_create(void) /* Create an empty context, as a
+                                              program starts in. */
+{
+    struct simlib_ctx *ctx;
+
+    ctx = (struct simlib_ctx *) calloc(1, sizeof(struct simlib_ctx));
+    if (ctx == NULL) {
+        printf("\nOut of memory for a simlib context\n");
+        exit(1);
+    }
+    ctx->variates    = VARIATE_INVERSION;
+    ctx->rng_backend = RNG_LCG;
+    return ctx;
+}
+
+
+struct simlib_ctx *simlib_ctx_use(struct simlib_ctx *ctx) /* Run the
+                                              simulation in "ctx" (or the
+                                              thread's default context if ctx
+                                              is NULL) from now on in this
+                                              thread, and return the context
+                                              used until now (NULL for the
+                                              default). */
+{
+    struct simlib_ctx *previous;
+
+    previous = ctx_current;
+    ctx_save(previous != NULL ? previous : &ctx_default);
+    ctx_load(ctx != NULL ? ctx : &ctx_default);
+    ctx_current = ctx;
+    return previous;
+}
+
+
+void simlib_ctx_free(struct simlib_ctx *ctx) /* Release context "ctx" and
+                                                everything in it. */
+{
+    struct master *row, *next;
+    int    list, i, s;
+
+    if (ctx == NULL) return;
+    if (ctx == ctx_current) {
+        printf("\nThe simlib context in use cannot be freed\n");
+        exit(1);
+    }
+
+    /* Free the records in every list, then the lists. */
+
+    if (ctx->head != NULL)
+        for (list = 0; list <= ctx->maxlist; ++list)
+            for (row = ctx->head[list]; row != NULL; row = next) {
+                next = (*row).sr;
+                free((char *)(*row).value);
+                free((char *)row);
+            }
+    free((char *)ctx->list_rank);
+    free((char *)ctx->list_size);
+    free((char *)ctx->head);
+    free((char *)ctx->tail);
+    free((char *)ctx->transfer);
+
+    /* Free the statistics and time series. */
+
+    if (ctx->series != NULL)
+        for (i = 0; i < TVAR_SIZE; ++i)
+            if (ctx->series[i] != NULL) {
+                free((char *)ctx->series[i]->levels);
+                free((char *)ctx->series[i]);
+            }
+    free((char *)ctx->series);
+    free((char *)ctx->sampst_stat);
+    free((char *)ctx->timest_stat);
+    free((char *)ctx->residence);
+    free((char *)ctx->preval);
+    free((char *)ctx->tlvc);
+    free((char *)ctx->list_stats);
+    free((char *)ctx->list_sampst);
+
+    /* Free the random-number streams. */
+
+    for (s = 0; s < ctx->rng_count; ++s) {
+        if (ctx->rng[s].st.buffer != NULL) {
+            free((char *)ctx->rng[s].st.buffer->u);
+            free((char *)ctx->rng[s].st.buffer);
+        }
+        free((char *)ctx->rng[s].st.sobol);
+    }
+    free(ctx->rng_block);
+
+    free((char *)ctx);
+}
+
+
+/* Replications.  To run replications 0 through n_reps - 1 of a model on
+   n_threads threads (all processors if n_threads <= 0), execute
+          simlib_replicate(model, n_reps, n_threads, &across);
+   where "model" is a function void model(int rep) that runs one complete
+   simulation:  it calls init_simlib, schedules, runs and stops as a main
+   program would.  Each replication runs in a fresh context (see
+   simlib_ctx_use) with the random-number backend and variate method of the
+   caller, and with streams 1 through LCG_STREAMS at the start of their
+   substreams for replication rep (lcgrand_crn(rep)); under the default LCG
+   backend this allows 20 replications (more stop the program before any
+   replication runs), and the MRG32k3a and Philox backends allow many
+   more.  Since replications run at once, the model's
+   own variables must be local to it or declared SIMLIB_THREAD.
+
+   When all replications are done, across holds the replication averages:
+   for each replication in which the variable had values, across.sampst[i]
+   is tallied (with weight 1) with the average of sampst variable i,
+   across.timest[i] with the time average of timest variable i (the list
+   lengths at TIM_VAR + list, as filest reports them) and
+   across.residence[list] with the average residence time in list "list".
+   Their mean fields are the across-replication means, stat_half_width gives
+   confidence intervals, min and max the extreme replications, and
+   across.time is the latest time any replication ended.  The replications
+   are combined in order, so the results do not depend on n_threads. */
+
+#define REP_VALUES  (SVAR_SIZE + TVAR_SIZE + LIST_SIZE) /* Per replication. */
+
+struct replication_job {
+    void   (*model)(int rep);
+    int    n_reps;
+    int    next;                /* Next replication to start. */
+    int    backend, variates;   /* Settings of the calling thread. */
+    double *value, *weight;     /* REP_VALUES of each, per replication. */
+    float  *time;               /* End time of each replication. */
+#ifdef SIMLIB_PTHREADS
+    pthread_mutex_t lock;       /* Guards next. */
+#endif
+};
+
+
+static void replication_run(struct replication_job *job, int rep,
+                            struct simlib_stats *snap)
+{
+    /* Run replication "rep" in a context of its own and keep its averages. */
+
+    struct simlib_ctx *ctx, *previous;
+    double *value, *weight;
+    int    ivar, list;
+
+    ctx      = simlib_ctx_create();
+    previous = simlib_ctx_use(ctx);
+    lcgrand_backend(job->backend);
+    variate_method(job->variates);
+    rng_grow(LCG_STREAMS);
+    lcgrand_crn(rep);
+
+    (*job->model)(rep);
+
+    if (sampst_stat == NULL) {
+        printf("\nReplication %d did not call init_simlib\n", rep);
+        exit(1);
+    }
+    simlib_stats_snapshot(snap);
+    simlib_ctx_use(previous);
+    simlib_ctx_free(ctx);
+
+    value  = job->value  + (size_t) rep * REP_VALUES;
+    weight = job->weight + (size_t) rep * REP_VALUES;
+    for (ivar = 1; ivar <= MAX_SVAR; ++ivar) {
+        value[ivar]  = snap->sampst[ivar].mean;
+        weight[ivar] = snap->sampst[ivar].weight;
+    }
+    for (ivar = 1; ivar <= MAX_TVAR; ++ivar) {
+        value[SVAR_SIZE + ivar]  = snap->timest[ivar].mean;
+        weight[SVAR_SIZE + ivar] = snap->timest[ivar].weight;
+    }
+    for (list = 0; list <= MAX_LIST; ++list) {
+        value[SVAR_SIZE + TVAR_SIZE + list]  = snap->residence[list].mean;
+        weight[SVAR_SIZE + TVAR_SIZE + list] = snap->residence[list].weight;
+    }
+    job->time[rep] = snap->time;
+}
+
+
+static void *replication_worker(void *arg)
+{
+    /* Run replications of job "arg" until none is left to start. */
+
+    struct replication_job *job;
+    struct simlib_stats    *snap;
+    int    rep;
+
+    job  = (struct replication_job *) arg;
+    snap = (struct simlib_stats *) malloc(sizeof(struct simlib_stats));
+    if (snap == NULL) {
+        printf("\nOut of memory for a replication\n");
+        exit(1);
+    }
+
+    for (;;) {
+#ifdef SIMLIB_PTHREADS
+        pthread_mutex_lock(&job->lock);
+#endif
+        rep = job->next++;
+#ifdef SIMLIB_PTHREADS
+        pthread_mutex_unlock(&job->lock);
+#endif
+        if (rep >= job->n_reps) break;
+        replication_run(job, rep, snap);
+    }
+
+    free((char *)snap);
+    return NULL;
+}
+
+
+static void replication_tally(struct statistic *stat, double value,
+                              double weight)
+{
+    /* Tally one replication's average "value", if it has any weight. */
+
+    if (weight > 0.0) stat_tally(stat, value, 1.0);
+}
+
+
+void simlib_replicate(void (*model)(int rep), int n_reps, int n_threads,
+                      struct simlib_stats *across) /* Run replications 0 ..
+                                                      n_reps - 1 of "model"
+                                                      on n_threads threads
+                                                      and tally their
+                                                      averages in across. */
+{
+    struct replication_job job;
+    double *value, *weight;
+    int    rep, ivar, list, t;
+#ifdef SIMLIB_PTHREADS
+    pthread_t *threads;
+#endif
+
+    if (n_reps < 0) {
+        printf("\n%d is an improper number of replications\n", n_reps);
+        exit(1);
+    }
+
+    /* Check before running any replication that the LCG has a disjoint
+       substream of every stream for each (see lcgrand_substream). */
+
+    if (rng_backend == RNG_LCG
+        && (long) n_reps * LCG_STREAMS > (MODLUS - 1) / LCG_SUBSTREAM_LENGTH) {
+        printf("\nThe LCG has disjoint substreams for only %d replications;"
+               " select RNG_MRG32K3A or RNG_PHILOX for %d\n",
+               (int) ((MODLUS - 1) / LCG_SUBSTREAM_LENGTH / LCG_STREAMS),
+               n_reps);
+        exit(1);
+    }
+
+    job.model    = model;
+    job.n_reps   = n_reps;
+    job.next     = 0;
+    job.backend  = rng_backend;
+    job.variates = variates;
+    job.value    = (double *) malloc(((size_t) n_reps * REP_VALUES + 1)
+                                     * sizeof(double));
+    job.weight   = (double *) malloc(((size_t) n_reps * REP_VALUES + 1)
+                                     * sizeof(double));
+    job.time     = (float *)  malloc(((size_t) n_reps + 1) * sizeof(float));
+    if (job.value == NULL || job.weight == NULL || job.time == NULL) {
+        printf("\nOut of memory for %d replications\n", n_reps);
+        exit(1);
+    }
+
+    /* Run the replications, on this thread and n_threads - 1 more. */
+
+#ifdef SIMLIB_PTHREADS
+    if (n_threads <= 0) n_threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (n_threads > n_reps) n_threads = n_reps;
+    if (n_threads < 1) n_threads = 1;
+
+    pthread_mutex_init(&job.lock, NULL);
+    threads = (pthread_t *) malloc(n_threads * sizeof(pthread_t));
+    if (threads == NULL) {
+        printf("\nOut of memory for %d threads\n", n_threads);
+        exit(1);
+    }
+    for (t = 1; t < n_threads; ++t)
+        if (pthread_create(&threads[t], NULL, replication_worker, &job) != 0) {
+            printf("\nCannot start replication thread %d\n", t);
+            exit(1);
+        }
+    replication_worker(&job);
+    for (t = 1; t < n_threads; ++t)
+        pthread_join(threads[t], NULL);
+    free((char *)threads);
+    pthread_mutex_destroy(&job.lock);
+#else
+    replication_worker(&job);
+#endif
+
+    /* Tally the averages of the replications in order. */
+
+    across->time = 0.0;
+    for (ivar = 1; ivar <= MAX_SVAR; ++ivar)
+        stat_init(&across->sampst[ivar]);
+    for (ivar = 1; ivar <= MAX_TVAR; ++ivar)
+        stat_init(&across->timest[ivar]);
+    for (list = 0; list <= MAX_LIST; ++list)
+        stat_init(&across->residence[list]);
+
+    for (rep = 0; rep < n_reps; ++rep) {
+        value  = job.value  + (size_t) rep * REP_VALUES;
+        weight = job.weight + (size_t) rep * REP_VALUES;
+        for (ivar = 1; ivar <= MAX_SVAR; ++ivar)
+            replication_tally(&across->sampst[ivar], value[ivar], weight[ivar]);
+        for (ivar = 1; ivar <= MAX_TVAR; ++ivar)
+            replication_tally(&across->timest[ivar], value[SVAR_SIZE + ivar],
+                              weight[SVAR_SIZE + ivar]);
+        for (list = 0; list <= MAX_LIST; ++list)
+            replication_tally(&across->residence[list],
+                              value[SVAR_SIZE + TVAR_SIZE + list],
+                              weight[SVAR_SIZE + TVAR_SIZE + list]);
+        if (job.time[rep] > across->time) across->time = job.time[rep];
+    }
+
+    free((char *)job.value);
+    free((char *)job.weight);
+    free((char *)job.time);
+}
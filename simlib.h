@@ -9,10 +9,12 @@
 
 /* Declare simlib global variables. */
 
-extern int    *list_rank, *list_size, next_event_type, maxatr, maxlist;
-extern float  *transfer, sim_time, prob_distrib[26];
-extern struct master {
+extern SIMLIB_THREAD int    *list_rank, *list_size, next_event_type, maxatr,
+                            maxlist;
+extern SIMLIB_THREAD float  *transfer, sim_time, prob_distrib[26];
+extern SIMLIB_THREAD struct master {
     float  *value;
+    float  time;                /* Time filed, for residence times. */
     struct master *pr;
     struct master *sr;
 } **head, **tail;
@@ -28,14 +30,82 @@ extern int   event_cancel(int event_type);
 extern float sampst(float value, int varibl);
 extern float timest(float value, int varibl);
 extern float filest(int list);
+extern void  sampst_reset(int varibl);
+extern void  timest_reset(int varibl);
+extern void  filest_reset(int list);
+extern void  list_set_stats(int list, int level);
+extern void  list_set_sampst(int list, int varibl);
+extern float filest_residence(int list);
+extern void  stat_init(struct statistic *stat);
+extern void  stat_tally(struct statistic *stat, double value, double weight);
+extern void  stat_merge(struct statistic *into, struct statistic *from);
+extern double stat_variance(struct statistic *stat);
+extern double stat_quantile(struct statistic *stat, double p);
+extern double stat_half_width(struct statistic *stat, double level);
+extern void  timest_sample_every(int varibl, float dt, int capacity);
+extern int   timest_series(int varibl, float levels[], int n);
+extern int   timest_series_write(FILE *unit, int varibl);
+extern void  simlib_stats_snapshot(struct simlib_stats *snap);
+extern void  simlib_stats_merge(struct simlib_stats *into,
+                                struct simlib_stats *from);
 extern void  out_sampst(FILE *unit, int lowvar, int highvar);
 extern void  out_timest(FILE *unit, int lowvar, int highvar);
 extern void  out_filest(FILE *unit, int lowlist, int highlist);
 extern float expon(float mean, int stream);
 extern int   random_integer(float prob_distrib[], int stream);
+extern struct discrete *discrete_build(float probs[], int n);
+extern int   discrete_sample(struct discrete *dist, int stream);
+extern void  discrete_free(struct discrete *dist);
 extern float uniform(float a, float b, int stream);
 extern float erlang(int m, float mean, int stream);
+extern double expon_d(double mean, int stream);
+extern double uniform_d(double a, double b, int stream);
+extern double erlang_d(int m, double mean, int stream);
+extern float normal(float mu, float sigma, int stream);
+extern double normal_d(double mu, double sigma, int stream);
+extern void  variate_method(int method);
+extern float gamma_variate(float alpha, float mean, int stream);
+extern double gamma_variate_d(double alpha, double mean, int stream);
+extern void  dist_init(struct distribution *dist, int type, double a,
+                       double b, double c);
+extern double dist_sample(struct distribution *dist, int stream);
+extern void  dist_batch(struct distribution *dist, double out[], int n,
+                        int stream);
+extern void  expon_batch(float out[], int n, float mean, int stream);
+extern void  uniform_batch(float out[], int n, float a, float b, int stream);
+extern void  erlang_batch(float out[], int n, int m, float mean, int stream);
+extern void  empirical_write(char *path, double values[], long n);
+extern struct empirical *empirical_load(char *path);
+extern double empirical_sample(struct empirical *emp, int stream);
+extern void  empirical_free(struct empirical *emp);
+extern long  trace_convert(char *csv_path, char *trace_path);
+extern struct trace *trace_open(char *path);
+extern int   trace_schedule(struct trace *tr, int type_of_event);
+extern void  trace_close(struct trace *tr);
+extern struct nhpp *nhpp_build(float start[], float rate[], int n,
+                               float period);
+extern float nhpp_next(struct nhpp *arrivals, int stream);
+extern void  nhpp_reset(struct nhpp *arrivals);
+extern void  nhpp_free(struct nhpp *arrivals);
 extern float lcgrand(int stream);
+extern double lcgrand_d(int stream);
 extern void  lcgrandst(long zset, int stream);
 extern long  lcgrandgt(int stream);
+extern void  lcgrand_jump(int stream, long k);
+extern void  lcgrand_substream(int stream, int rep);
+extern void  lcgrand_backend(int backend);
+extern void  lcgrand_fill(int stream, float u[], int n);
+extern void  lcgrand_buffer(int stream, int size);
+extern void  lcgrand_entity(int stream, long entity);
+extern void  lcgrand_crn(int rep);
+extern void  lcgrand_sobol(int stream, int dims);
+extern void  lcgrand_set_antithetic(int stream, int on);
+extern void  simlib_antithetic(void (*model)(double est[]), int n,
+                               double est[]);
+extern double philox_uniform(int rep, int stream, long entity, long draw);
+extern struct simlib_ctx *simlib_ctx_create(void);
+extern struct simlib_ctx *simlib_ctx_use(struct simlib_ctx *ctx);
+extern void  simlib_ctx_free(struct simlib_ctx *ctx);
+extern void  simlib_replicate(void (*model)(int rep), int n_reps,
+                              int n_threads, struct simlib_stats *across);
 
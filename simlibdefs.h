@@ -16,6 +16,18 @@
 #define SVAR_SIZE   26      /* MAX_SVAR + 1. */
 #define TVAR_SIZE   51      /* MAX_TVAR + 1. */
 
+/* Define the storage class of the simlib state.  Every thread runs its own
+   simulation, in the context it selected with simlib_ctx_use; without
+   thread-local storage there is one simulation per process. */
+
+#if defined(__GNUC__)
+#define SIMLIB_THREAD  __thread
+#elif defined(_MSC_VER)
+#define SIMLIB_THREAD  __declspec(thread)
+#else
+#define SIMLIB_THREAD
+#endif
+
 /* Define options for list_file and list_remove. */
 
 #define FIRST        1      /* Insert at (remove from) head of list. */
@@ -23,6 +35,35 @@
 #define INCREASING   3      /* Insert in increasing order. */
 #define DECREASING   4      /* Insert in decreasing order. */
 
+/* Define statistics levels for list_set_stats. */
+
+#define STATS_NONE      0   /* Keep no statistics on the list. */
+#define STATS_TIME_AVG  1   /* Time-average list length (the default). */
+#define STATS_FULL      2   /* List length plus residence times. */
+
+/* Define random-number backends for lcgrand_backend. */
+
+#define RNG_LCG         1   /* Prime modulus multiplicative LCG (default). */
+#define RNG_MRG32K3A    2   /* L'Ecuyer's combined MRG32k3a. */
+#define RNG_PHILOX      3   /* Counter-based Philox4x32-10. */
+
+#define SOBOL_MAX_DIMS  10  /* Dimensions available to lcgrand_sobol. */
+
+/* Define methods for variate_method. */
+
+#define VARIATE_INVERSION  1    /* Inverse transform (the default). */
+#define VARIATE_ZIGGURAT   2    /* Ziggurat exponentials and normals. */
+
+/* Define distribution types for dist_init, with their parameters a, b, c. */
+
+#define DIST_NORMAL      1  /* Mean a, standard deviation b. */
+#define DIST_LOGNORMAL   2  /* Mean a, standard deviation b (of the variate). */
+#define DIST_WEIBULL     3  /* Shape a, scale b. */
+#define DIST_GAMMA       4  /* Shape a, mean b. */
+#define DIST_BETA        5  /* Shapes a and b, on [0, 1]. */
+#define DIST_TRIANGULAR  6  /* Minimum a, mode b, maximum c. */
+#define DIST_PARETO      7  /* Shape a, minimum (scale) b. */
+
 /* Define some other values. */
 
 #define LIST_EVENT  25      /* Event list number. */
@@ -33,3 +74,110 @@
 #define EVENT_TIME   1      /* Attribute 1 in event list is event time. */
 #define EVENT_TYPE   2      /* Attribute 2 in event list is event type. */
 
+
+/* Define the histogram layout of a statistic.  Bin 0 collects values below
+   2^STAT_MIN_EXP (including zero and negative values); each following group of
+   STAT_SUBBINS bins splits one power-of-two octave into equal parts, and the
+   last bin also collects everything above the top octave. */
+
+#define STAT_MIN_EXP   -24      /* Smallest binned value is 2^STAT_MIN_EXP. */
+#define STAT_OCTAVES    48      /* Number of octaves covered by the bins. */
+#define STAT_SUBBINS     4      /* Bins per octave. */
+#define STAT_BINS      193      /* STAT_OCTAVES * STAT_SUBBINS + 1. */
+
+/* Mergeable accumulator kept for every sampst and timest variable.  For a
+   sampst variable the weight is the number of observations; for a timest
+   variable it is the elapsed simulated time, so that mean is the time
+   average. */
+
+struct statistic {
+    double weight;              /* Number of observations or elapsed time. */
+    double mean;                /* Weighted mean of the values. */
+    double m2;                  /* Weighted sum of squared deviations. */
+    double min, max;            /* Extremes (defaults 1E30 and -1E30). */
+    double hist[STAT_BINS];     /* Weight falling in each histogram bin. */
+};
+
+/* Discrete distribution on 1, ..., n prepared by discrete_build for
+   sampling by the alias method with discrete_sample.  Column i (0 to n - 1)
+   returns i + 1 with probability cutoff[i], else alias[i]. */
+
+struct discrete {
+    int    n;                   /* Number of outcomes. */
+    double *cutoff;             /* Probability of keeping each column. */
+    int    *alias;              /* Outcome returned otherwise. */
+};
+
+/* Distribution prepared by dist_init for dist_sample and dist_batch, with
+   the constants each sample needs worked out once. */
+
+struct distribution {
+    int    type;                /* DIST_NORMAL, ..., DIST_PARETO. */
+    double a, b, c;             /* Parameters as given to dist_init. */
+    double k[6];                /* Precomputed constants. */
+};
+
+/* Empirical distribution loaded by empirical_load from a file written by
+   empirical_write: the magic number EMPIRICAL_MAGIC, the number n of values
+   as a long long, and the n values sorted into increasing order, as doubles
+   in the byte order of the machine.  The values are read in place from a
+   read-only mapping of the file where possible. */
+
+#define EMPIRICAL_MAGIC  "SIMLEMP1"     /* 8 bytes, no terminator. */
+
+struct empirical {
+    long   n;                   /* Number of values. */
+    double *x;                  /* The sorted values, inside file. */
+    char   *file;               /* The whole file, mapped or read. */
+    size_t size;                /* Length of the file. */
+    int    mapped;              /* Nonzero if file is a mapping. */
+};
+
+/* Arrival trace opened by trace_open from a file written by trace_convert:
+   the magic number TRACE_MAGIC, the number n of records and the number
+   nattr of attributes per record as long longs, and n records of nattr + 1
+   doubles (arrival time, then the attributes) in order of arrival time. */
+
+#define TRACE_MAGIC  "SIMLTRC1"         /* 8 bytes, no terminator. */
+
+struct trace {
+    long   n;                   /* Number of records. */
+    int    nattr;               /* Attributes per record. */
+    long   next;                /* Index of the next record to schedule. */
+    double origin;              /* Time of the first record (time 0). */
+    double *rec;                /* The records, inside file. */
+    char   *file;               /* The whole file, mapped or read. */
+    size_t size;                /* Length of the file. */
+    int    mapped;              /* Nonzero if file is a mapping. */
+};
+
+/* Nonhomogeneous Poisson arrival process built by nhpp_build, with rate
+   rate[i] from start[i] to start[i + 1] (start[n] is the period, or
+   infinity if the profile does not repeat).  cum[i] is the expected number
+   of arrivals before start[i]. */
+
+struct nhpp {
+    int    n;                   /* Number of pieces. */
+    double *start;              /* Start of each piece, start[0] = 0. */
+    double *rate;               /* Arrival rate in each piece. */
+    double *cum;                /* Cumulative rate at each start. */
+    double period;              /* Length of the profile, 0 if it ends. */
+    double lambda;              /* Cumulative rate at the last arrival. */
+    long   cycle;               /* Period of the last arrival. */
+    int    piece;               /* Piece of the last arrival. */
+};
+
+/* Simulation context (lists, clock, statistics and random-number streams)
+   created by simlib_ctx_create; its fields are private to simlib.c. */
+
+struct simlib_ctx;
+
+/* Snapshot of every statistic, filled in by simlib_stats_snapshot.  Entry
+   TIM_VAR + list of timest holds the length statistics of list "list". */
+
+struct simlib_stats {
+    float            time;               /* sim_time of the snapshot. */
+    struct statistic sampst[SVAR_SIZE];  /* sampst variables 1..MAX_SVAR. */
+    struct statistic timest[TVAR_SIZE];  /* timest variables 1..MAX_TVAR. */
+    struct statistic residence[LIST_SIZE];  /* Residence times in lists. */
+};
@@ -67,6 +67,11 @@ main()  /* Main function. */
 
         maxatr = 4;  /* NEVER SET maxatr TO BE SMALLER THAN 4. */
 
+        /* Restart the random-number streams so that every configuration sees
+           the same random inputs (common random numbers). */
+
+        lcgrand_crn(0);
+
         /* Initialize the non-simlib statistical counter. */
 
         num_responses = 0;